@@ -47,18 +47,47 @@
 /*-------------------------------------------------------------------*
 *    HEADER FILES                                                    *
 *--------------------------------------------------------------------*/
+ #define _GNU_SOURCE // thread affinity and sched_getcpu()
  #include <stdio.h>
  #include <stdlib.h>
  #include <stdbool.h>
  #include <time.h>
  #include <string.h>
  #include <ctype.h>
+ #include <stdint.h>
+ #include <unistd.h>
+ #ifdef __linux__
+ #include <sched.h>
+ #include <dirent.h>
+ #include <sys/syscall.h>
+ #endif
 
  #define HAVE_NCURSES_H // Delete this line if you don't want to use ncurses.h library
  #ifdef HAVE_NCURSES_H
  #include <ncurses.h>
  #endif
 
+ #define HAVE_PTHREAD_H // Delete this line if you don't want to use threads (large board runs use one thread)
+ #ifdef HAVE_PTHREAD_H
+ #include <pthread.h>
+ #endif
+
+ #define HAVE_SYS_SOCKET_H // Delete this line if you don't want the frame server and viewer
+ #ifdef HAVE_SYS_SOCKET_H
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <netinet/in.h>
+ #include <arpa/inet.h>
+ #include <netdb.h>
+ #include <fcntl.h>
+ #include <errno.h>
+ #include <poll.h>
+ #include <sys/stat.h>
+ #ifndef MSG_NOSIGNAL
+ #define MSG_NOSIGNAL 0
+ #endif
+ #endif
+
 
 /*-------------------------------------------------------------------*
 *    GLOBAL VARIABLES AND CONSTANTS                                  *
@@ -74,6 +103,58 @@
  #define YELLOW "\033[0;33m"
  #define MAGENTA "\033[0;35m"
  #define RESET_COLOR "\033[0m"
+
+ #define BENCH_GENERATIONS 1000 // generations stepped by each engine in runBenchmark()
+ #define BENCH_SEED 2023        // fixed seed so every benchmark run steps the same soup
+
+ #define REDRAW_HZ 30              // screen updates per second in RENDER_FAST mode
+ #define MAX_DELAY 10000           // slowest delay between generations (ms)
+ #define KEY_POLL_GENERATIONS 256  // generations between keyboard checks when nothing is drawn
+
+ #define SPARSE_TILE_ROWS 32          // sparse engine tile = 64 columns x SPARSE_TILE_ROWS rows
+ #define AUTO_SAMPLE_GENERATIONS 2048 // generations between board samples in automatic engine mode
+ #define AUTO_SPARSE_ACTIVITY 0.02    // below this share of cells changing per generation use sparse engine
+ #define AUTO_SPARSE_BOX 0.25         // or when live cells fit in this share of the board
+ #define AUTO_TRIALS 3                // timed steps per engine when choosing between dense and lookup table
+ #define ENGINE_LOG "engine.log"      // automatic engine switches are appended here
+ #define TEMPORAL_TILE_ROWS 64        // temporal blocking tile, with halo about 20 KB at k = 8
+ #define TEMPORAL_TILE_WORDS 16       // 1024 columns
+ #define TEMPORAL_MAX_K 64            // one halo word on each side is enough for 64 generations
+ #define TEMPORAL_BENCH_SIZE 16384    // 32 MB per generation, larger than cache
+ #define TEMPORAL_BENCH_GENERATIONS 16
+ #define FIXED_BENCH_CELLS 134217728  // cells stepped by each kernel in benchmarkFixed()
+ #define LARGE_MAX_THREADS 256        // workers of a large board run
+ #define LARGE_PAGE_SIZE 4096         // large boards are page aligned, NUMA nodes are looked up per page
+ #define LARGE_NODE_SAMPLES 64        // pages checked per stripe to find its memory node
+ #define LARGE_MAX_NODES 64
+ #define SERVER_BACKLOG 32            // viewers waiting to be accepted, any number can be connected
+ #define SERVER_CLIENT_BUFFER 262144  // bytes waiting for a viewer before it gets a keyframe instead
+ #define SERVER_FLUSH_SECONDS 0.01    // sockets are written at most this often
+ #define SERVER_DROP_SECONDS 5.0      // viewer that can not take a keyframe this long is disconnected
+ #define SERVER_CLOSE_SECONDS 1.0     // longest wait for viewers to take the last frames when game ends
+ #define FRAME_HEADER_SIZE 21         // type, generation, width, height, payload length
+ #define FRAME_MAX_PAYLOAD 16777216   // longer frames are taken as broken by viewers
+
+ #define ACTIVITY_TILE 8              // activity map tile size, one byte of a packed row
+ #define ACTIVITY_LOW_PLANES 4        // bit planes added to every generation (addToPlanes() is written out for 4), folded every 15 generations
+ #define ACTIVITY_PLANES 8            // bit planes per word: counters are flushed every 255 generations
+ #define ACTIVITY_PREFIX "activity"  // activity map files are written as activity_*.pgm / .csv
+
+ // Pointer to row y of a packed grid. Row -1 and rows height, height + 1 are dead padding.
+ #define GRID_ROW(grid, y) ((grid)->rows + (size_t)((y) + 1) * (grid)->words)
+
+ // Board sizes (width, height) that get their own dense kernel with constant sizes, see FIXED_KERNEL.
+ // Change at build time e.g. with -D'FIXED_SIZES=X(64, 64) X(512, 512)'
+ #ifndef FIXED_SIZES
+ #define FIXED_SIZES X(64, 64) X(256, 256) X(1024, 1024)
+ #endif
+
+ // Fully unrolls the following loop when its trip count is a constant, also at -O2
+ #if defined(__GNUC__) || defined(__clang__)
+ #define UNROLL_FULLY _Pragma("GCC unroll 64")
+ #else
+ #define UNROLL_FULLY
+ #endif
  
  
 
@@ -93,6 +174,238 @@
  
  struct cell **board; 
 
+ /* Stepping engines */
+ enum engine_type
+ {
+     ENGINE_REFERENCE, // calculateFuture() on struct cell **board
+     ENGINE_TABLE,     // memoized: 4x4 -> 2x2 lookup table on a packed grid
+     ENGINE_DENSE,     // 64 cells per bitwise operation on a packed grid
+     ENGINE_SPARSE,    // dense engine only on tiles where something changes
+     ENGINE_AUTO       // switches between table, dense and sparse while running
+ };
+
+ // Board packed one bit per cell, 64 cells per word, rows stored one after another
+ struct lifeGrid
+ {
+     int width;      // cells per row
+     int height;     // rows
+     int words;      // 64-bit words per row
+     uint64_t *rows; // height + 3 rows: one dead row above the board, two below
+ };
+
+ /* Game run controls */
+ enum render_type
+ {
+     RENDER_EVERY, // draw every generation
+     RENDER_NTH,   // draw every render_every'th generation
+     RENDER_FAST,  // step as fast as possible, draw REDRAW_HZ times per second
+     RENDER_NONE   // headless: step as fast as possible, only status line is updated
+ };
+
+ struct runControl
+ {
+     bool paused;
+     bool step;       // calculate one generation while paused
+     bool quit;
+     int delay_time;  // milliseconds between drawn generations
+ };
+
+ enum render_type render_mode = RENDER_EVERY;
+ int render_every = 1;
+
+ // Tiles the sparse engine calculates, one flag per tile
+ struct sparseTiles
+ {
+     int tiles_x;                 // = words per row
+     int tiles_y;
+     unsigned char *active;       // tile or its neighbour changed last generation
+     unsigned char *next_active;
+ };
+
+ // Automatic engine selection
+ struct autoSelect
+ {
+     enum engine_type running;  // engine calculating generations now
+     long generations;          // generations since start
+     long changes;              // changed cells since last sample
+     int switches;              // engine changes since start
+     char reason[160];          // why running engine was chosen
+ };
+
+ enum engine_type engine = ENGINE_REFERENCE; // engine used by startGameOfLife
+ const char *engine_names[] = {"reference", "lookup table", "dense", "sparse", "auto"};
+ struct lifeGrid life[2];                    // generation n and n + 1 for packed engines
+ int life_now = 0;                           // index of generation n in life[]
+ unsigned char block_table[65536];           // 4x4 neighbourhood -> next state of its 2x2 centre
+ bool block_table_ready = false;
+ struct sparseTiles sparse;
+ struct autoSelect autoselect;
+
+ // Scratch memory of temporal blocking, one for each thread stepping at the same time
+ struct temporalScratch
+ {
+     int max_k;          // largest k the tiles have room for
+     uint64_t *tile[2];  // tile with halo, two generations
+ };
+
+ /* Benchmarks */
+ // Grids of one benchmark: start board, two generations and the board every method should reach
+ struct benchRun
+ {
+     struct lifeGrid start;
+     struct lifeGrid grid[2];
+     struct lifeGrid expected;
+     int now;            // grid holding the last generation
+ };
+
+ // How timeBenchRun() steps the grids
+ struct benchStep
+ {
+     enum engine_type type;            // engine for stepPacked()
+     bool with_activity;               // also update the activity map
+     int k;                            // more than 1 = stepTemporal(), k generations per sweep
+     struct temporalScratch *scratch;  // tiles of stepTemporal()
+     int (*kernel)(const struct lifeGrid *now, struct lifeGrid *next); // not NULL = used instead of the engine
+ };
+
+ /* Large board runs */
+ enum placement_type
+ {
+     PLACEMENT_FIRST_TOUCH, // each worker writes its own stripe first
+     PLACEMENT_MASTER       // main thread writes the whole board
+ };
+
+ enum pinning_type
+ {
+     PIN_NONE,
+     PIN_COMPACT,  // worker i -> i'th allowed cpu
+     PIN_SCATTER   // consecutive workers -> different NUMA nodes
+ };
+
+ struct largeRun;
+
+ // One thread of a large board run
+ struct worker
+ {
+     int id;
+     int y_begin;        // first row of the stripe
+     int y_end;          // row after the stripe
+     int cpu;            // cpu to pin to, -1 = not pinned
+     int cpu_used;       // cpu the worker ran on at the end
+     int memory_node;    // node holding most of the stripe, -1 = unknown
+     struct temporalScratch scratch;
+     struct largeRun *run;
+     #ifdef HAVE_PTHREAD_H
+     pthread_t thread;
+     #endif
+ };
+
+ struct largeRun
+ {
+     struct lifeGrid grid[2];
+     int generations;
+     int k;              // generations per sweep, more than 1 = temporal blocking
+     int final;          // grid holding the last generation
+     int threads;
+     double start_time;
+     double end_time;
+     struct worker *workers;
+     #ifdef HAVE_PTHREAD_H
+     pthread_barrier_t barrier;
+     pthread_mutex_t start_lock;  // held while workers are created
+     bool aborted;                // a worker could not be created, nobody steps
+     #endif
+ };
+
+ int run_threads = 0; // 0 = one per cpu
+ int run_k = 1;       // generations per sweep of large board runs
+ enum placement_type placement = PLACEMENT_FIRST_TOUCH;
+ enum pinning_type pinning = PIN_COMPACT;
+ const char *placement_names[] = {"first touch", "master thread"};
+ const char *pinning_names[] = {"none", "compact", "scatter"};
+
+ /* Frame server */
+ struct byteBuffer
+ {
+     unsigned char *data;
+     size_t length;
+     size_t capacity;
+     size_t sent;        // bytes already sent from the start of data
+ };
+
+ struct viewerClient
+ {
+     int fd;
+     bool needs_keyframe;   // deltas were skipped, next frame is a keyframe
+     double behind_since;   // when viewer started waiting for a keyframe
+     struct byteBuffer out;
+ };
+
+ struct frameServer
+ {
+     int listen_fd;         // -1 = not running
+     int client_count;
+     int client_capacity;
+     struct viewerClient *clients;
+     long generation;
+     double last_flush;
+     long sent_frames;
+     long keyframes;
+     long dropped;
+     struct byteBuffer frame;     // delta of this generation
+     struct byteBuffer keyframe;  // whole board of this generation
+     struct byteBuffer births;
+     struct byteBuffer deaths;
+ };
+
+ // Board received by a viewer, one byte per cell
+ struct remoteBoard
+ {
+     int width;
+     int height;
+     long generation;
+     long frames;
+     unsigned char *cells;
+ };
+
+ char server_address[100] = ""; // empty = frame server off
+ struct frameServer server = {.listen_fd = -1};
+
+ /* Activity map */
+ enum activity_type
+ {
+     ACTIVITY_OFF,
+     ACTIVITY_PGM, // grayscale images
+     ACTIVITY_CSV
+ };
+
+ // Counters accumulated over a run. Cell counter rows are padded to a multiple of 64.
+ // Each step is first added to low bit planes (bit p of 64 counters in one word), 64 cells per operation.
+ // Low planes are added to the other planes before they overflow, and those to the 32-bit counters.
+ // Tile totals are not counted while stepping, countTiles() builds them from births and the first and last state.
+ struct activityMap
+ {
+     int width;
+     int height;
+     int stride;              // counters per row
+     int tiles_x;             // tiles per row, stride / ACTIVITY_TILE
+     int tiles_y;
+     long generations;
+     int pending;             // generations in the bit planes
+     uint64_t *birth_low;     // ACTIVITY_LOW_PLANES words per 64 cells
+     uint64_t *alive_low;
+     uint64_t *birth_planes;  // ACTIVITY_PLANES words per 64 cells
+     uint64_t *alive_planes;
+     uint64_t *first;         // state before the first step, 64 cells per word
+     uint64_t *last;          // state after the latest step
+     uint32_t *births;        // how many times each cell was born
+     uint32_t *alive;         // generations each cell was alive
+     uint32_t *tiles;         // changed cells per ACTIVITY_TILE x ACTIVITY_TILE tile, see countTiles()
+ };
+
+ enum activity_type activity_export = ACTIVITY_OFF;
+ struct activityMap activity;
+
 /*-------------------------------------------------------------------*
 *    FUNCTION PROTOTYPES                                             *
 *--------------------------------------------------------------------*/
@@ -100,6 +413,10 @@
  // Game of life
 
     void startGameOfLife(int delay_time);
+    int readKey(void);
+    void waitForKeys(int milliseconds, struct runControl *control);
+    void handleKey(int key, struct runControl *control);
+    void printStatus(int gen, const struct runControl *control);
 
  // Game state / logic
 
@@ -107,6 +424,63 @@
     void printState(void);
     void printCellState(bool alive_or_dead, char color);
     int calculateFuture(void);
+    int nextCellState(int alive, int neighbours);
+    void advanceState(void);
+    int stepGeneration(bool render, bool record);
+
+ // Packed grid engines
+
+    bool allocateGrid(struct lifeGrid *grid, int width, int height);
+    void freeGrid(struct lifeGrid *grid);
+    void boardToGrid(struct lifeGrid *grid);
+    void gridToBoard(const struct lifeGrid *now, const struct lifeGrid *next);
+    bool prepareEngine(void);
+    void releaseEngine(void);
+    void buildBlockTable(void);
+    int stepBlockTable(const struct lifeGrid *now, struct lifeGrid *next);
+    int popcount64(uint64_t word);
+    uint64_t lastWordMask(const struct lifeGrid *grid);
+    uint64_t nextLifeWord(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int w, int words);
+    uint64_t lifeBits(const uint64_t *before, const uint64_t *centre, const uint64_t *after);
+    int stepDense(const struct lifeGrid *now, struct lifeGrid *next);
+    int stepDenseRows(const struct lifeGrid *now, struct lifeGrid *next, int y_begin, int y_end);
+    int stepDenseGeneric(const struct lifeGrid *now, struct lifeGrid *next);
+    #define X(W, H) int stepFixed##W##x##H(const struct lifeGrid *now, struct lifeGrid *next);
+    FIXED_SIZES
+    #undef X
+    bool allocateSparse(int width, int height);
+    void freeSparse(void);
+    void resetSparse(void);
+    int stepSparse(const struct lifeGrid *now, struct lifeGrid *next);
+    bool allocateTemporal(struct temporalScratch *scratch, int max_k);
+    void freeTemporal(struct temporalScratch *scratch);
+    int stepTemporal(const struct lifeGrid *now, struct lifeGrid *next, int k, struct temporalScratch *scratch);
+    int stepTemporalRows(const struct lifeGrid *now, struct lifeGrid *next, int k, int y_begin, int y_end,
+                         struct temporalScratch *scratch);
+    int stepPacked(enum engine_type type, const struct lifeGrid *now, struct lifeGrid *next);
+
+ // Automatic engine selection
+
+    void resetAuto(void);
+    int stepAuto(const struct lifeGrid *now, struct lifeGrid *next);
+    void chooseEngine(const struct lifeGrid *now, struct lifeGrid *next);
+    double timeEngine(enum engine_type type, const struct lifeGrid *now, struct lifeGrid *next);
+    void logEngineSwitch(enum engine_type from, enum engine_type to, const char *reason);
+
+ // Activity map
+
+    bool allocateActivity(int width, int height);
+    void freeActivity(void);
+    void accumulateRow(int y, const uint64_t *now, const uint64_t *next, int words);
+    void addToPlanes(uint64_t *planes, uint64_t mask);
+    void foldPlanes(uint64_t *low, uint64_t *planes);
+    void foldActivity(void);
+    void flushActivity(void);
+    void countTiles(void);
+    void accumulateActivity(const struct lifeGrid *now, const struct lifeGrid *next);
+    void accumulateBoard(void);
+    bool writeActivityFile(const char *filename, const uint32_t *counts, int width, int height, int stride);
+    bool exportActivity(void);
 
  // Memory allocation and stream clear
 
@@ -124,7 +498,62 @@
 
     void printInstructions(char state[]);
     void modifySettings(void);
+    void selectEngine(void);
+    void selectRenderMode(void);
+    void selectActivity(void);
     void delay(int milliseconds);
+    double getTime(void);
+    void runBenchmark(void);
+    void benchmarkPacked(const char *name, enum engine_type type, bool with_activity, struct benchRun *run, double reference_time);
+    void benchmarkTemporal(void);
+    void benchmarkFixed(void);
+    void benchmarkFixedSize(int width, int height, int (*kernel)(const struct lifeGrid *now, struct lifeGrid *next));
+    bool allocateBenchRun(struct benchRun *run, int width, int height);
+    void freeBenchRun(struct benchRun *run);
+    void fillRandomGrid(struct lifeGrid *grid);
+    double timeBenchRun(struct benchRun *run, const struct benchStep *step, int generations);
+    void printCheck(const struct benchRun *run);
+
+ // Large board runs
+
+    void runLargeBoard(void);
+    void freeLargeRun(struct largeRun *run);
+    void *runWorker(void *arg);
+    void waitWorkers(struct largeRun *run);
+    void initStripe(struct largeRun *run, int y_begin, int y_end);
+    uint64_t mixBits(uint64_t x);
+    bool allocateGridPlaced(struct lifeGrid *grid, int width, int height);
+    int listCpus(int *cpus, int max);
+    void scatterCpus(const int *cpus, int count, int *order);
+    int cpuNode(int cpu);
+    int memoryNode(const void *start, size_t bytes);
+    void selectPlacement(void);
+
+ // Frame server and viewer
+
+    bool startServer(void);
+    void stopServer(void);
+    void publishFrame(void);
+    void serveViewers(void);
+    void sendKeyframes(bool future);
+    void acceptViewers(void);
+    void flushViewers(double now);
+    void dropViewer(int index);
+    void frameRows(int y, uint64_t *now, uint64_t *next);
+    void encodeDelta(void);
+    void encodeKeyframe(bool future);
+    void appendFrameHeader(struct byteBuffer *buffer, char type);
+    void finishFrame(struct byteBuffer *buffer);
+    void appendBytes(struct byteBuffer *buffer, const void *bytes, size_t count);
+    void appendVarint(struct byteBuffer *buffer, uint64_t value);
+    int lowestBit(uint64_t word);
+    bool isNumber(const char *string);
+    void watchRemoteGame(void);
+    int connectViewer(const char *address);
+    bool applyFrame(struct remoteBoard *view, const unsigned char *frame, size_t length);
+    bool readVarint(const unsigned char **data, const unsigned char *end, uint64_t *value);
+    void printRemoteBoard(const struct remoteBoard *view);
+    void selectServer(void);
 
 /*********************************************************************
 *    MAIN PROGRAM                                                      *
@@ -166,6 +595,30 @@ int main(void)
             case 'C': // SHOW HIGHSCORE
                 printf("show highscore");
                 break;
+            case 'D': // BENCHMARK
+                printInstructions("benchmark");
+                switch (ask_command())
+                {
+                    case 'A':
+                        runBenchmark();
+                        break;
+                    case 'B':
+                        benchmarkTemporal();
+                        break;
+                    case 'C':
+                        runLargeBoard();
+                        break;
+                    case 'D':
+                        benchmarkFixed();
+                        break;
+                    default:
+                        printf("%sInvalid command.", RED);
+                        break;
+                }
+                break;
+            case 'E': // VIEWER
+                watchRemoteGame();
+                break;
             case 'H':
                 printInstructions("welcome");
                 break;
@@ -244,28 +697,132 @@ int ask_integer(void)
  DESCRIPTION: Runs the game and displays game state to user
 	Input: delay_time
 	Output: actions (how many cell's states were changed)
-  Used global variables: -
- REMARKS when using this function: Board should be initialized beforehand 
+  Used global variables: render_mode, render_every, activity_export, server_address
+ REMARKS when using this function: Board should be initialized beforehand. Activity map is written when game ends.
+                                    Frame server runs while the game runs if server_address is set.
+                                    Keys are read without blocking while the game runs (see printInstructions("gameoflife")).
 *********************************************************************/
 void startGameOfLife(int delay_time)
 {
     #ifdef HAVE_NCURSES_H
     initscr();
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
     #endif
 
-    int actions = 0, action_count = 0, gen = 0;
+    int actions = 0, action_count = 0, gen = 0, key;
+    bool render = true;
+    double last_frame = 0;
+    struct runControl control = {false, false, false, delay_time};
+
+    // Packed engines keep their own copy of the board
+    if (prepareEngine() == false)
+    {
+        #ifdef HAVE_NCURSES_H
+        endwin();
+        #endif
+        fprintf(stderr, "Error: Failed to allocate memory for engine\n");
+        return;
+    }
+    if (activity_export != ACTIVITY_OFF && allocateActivity(xy_size[0], xy_size[1]) == false)
+    {
+        #ifdef HAVE_NCURSES_H
+        endwin();
+        #endif
+        releaseEngine();
+        return;
+    }
+    if (server_address[0] != '\0' && startServer() == false)
+    {
+        #ifdef HAVE_NCURSES_H
+        endwin();
+        #endif
+        if (activity_export != ACTIVITY_OFF)
+            freeActivity();
+        releaseEngine();
+        return;
+    }
     
-    // Print state until there is no future
-    while ((actions = calculateFuture()) != 0)
+    // Print state until there is no future or user quits
+    while (control.quit == false)
     {
-        printState();
+        // Keys are checked on every drawn generation, and every KEY_POLL_GENERATIONS otherwise
+        if (render || gen % KEY_POLL_GENERATIONS == 0)
+        {
+            while ((key = readKey()) != 0)
+                handleKey(key, &control);
+            if (control.quit)
+                break;
+        }
+
+        if (control.paused && control.step == false)
+        {
+            printStatus(gen, &control);
+            waitForKeys(1000 / REDRAW_HZ, &control);
+            continue;
+        }
+
+        // Decide if this generation is drawn
+        switch (render_mode)
+        {
+            case RENDER_NTH:
+                render = gen % render_every == 0;
+                break;
+            case RENDER_FAST:
+                render = getTime() - last_frame >= 1.0 / REDRAW_HZ;
+                break;
+            case RENDER_NONE:
+                render = false;
+                break;
+            default:
+                render = true;
+                break;
+        }
+        // Single step is always shown
+        if (control.step)
+        {
+            render = true;
+            control.step = false;
+        }
+
+        if ((actions = stepGeneration(render, true)) == 0)
+            break;
         gen++;
         action_count+=actions;
 
-        delay(delay_time);
+        if (render)
+        {
+            printState();
+            printStatus(gen, &control);
+            last_frame = getTime();
+
+            // Delay is between drawn generations, fast mode runs without delay
+            if (render_mode != RENDER_FAST && control.paused == false)
+                waitForKeys(control.delay_time, &control);
+        }
+        // Headless: only status line is updated
+        else if (render_mode == RENDER_NONE && getTime() - last_frame >= 1.0 / REDRAW_HZ)
+        {
+            printStatus(gen, &control);
+            last_frame = getTime();
+        }
     }
+
+    // Last generation was not drawn, bring board up to date. Board has no future so this does not change it
+    // and it is not recorded as a generation.
+    if (actions == 0 && render == false)
+        stepGeneration(true, false);
+
     #ifdef HAVE_NCURSES_H
-    getch();
+    if (actions == 0)
+        printState();
+    printStatus(gen, &control);
+    printw("\nGame ended. Press any key.");
+    refresh();
+    timeout(1000 / REDRAW_HZ);
+    while (getch() == ERR)
+        serveViewers();
     endwin();
     #else
     printf("\n----FINAL STATE----\n");
@@ -274,6 +831,174 @@ void startGameOfLife(int delay_time)
     // syntax: variable ? 'true' : 'false' || same as: if (variable == 1) .. else ..
     printf("Game ended. You survived %d generation(s). Total cell deaths/respawns were: %d", gen ? gen + 1: gen, action_count);
     #endif
+
+    if (engine == ENGINE_AUTO)
+        printf("\nAutomatic engine switched %d time(s), ended with %s: %s", autoselect.switches,
+               engine_names[autoselect.running], autoselect.reason);
+
+    if (activity_export != ACTIVITY_OFF)
+    {
+        printf("\n");
+        exportActivity();
+        freeActivity();
+    }
+
+    if (server.listen_fd >= 0)
+    {
+        stopServer();
+        printf("\nFrame server sent %ld frame(s) and %ld keyframe(s), dropped %ld viewer(s)", server.sent_frames, server.keyframes, server.dropped);
+    }
+
+    releaseEngine();
+}
+
+/*********************************************************************
+ NAME: readKey
+ DESCRIPTION: Returns key pressed by user without waiting
+	Input: -
+	Output: key, 0 if no key was pressed
+  Used global variables: -
+ REMARKS when using this function: ncurses should be initialized with nodelay() beforehand. Without ncurses returns always 0
+*********************************************************************/
+int readKey(void)
+{
+    #ifdef HAVE_NCURSES_H
+    int key = getch();
+
+    return key == ERR ? 0 : key;
+    #else
+    return 0;
+    #endif
+}
+
+/*********************************************************************
+ NAME: waitForKeys
+ DESCRIPTION: Waits given time, or until user presses a key
+	Input: milliseconds, control
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: pressed key is passed to handleKey(). Frame server viewers are served while waiting.
+*********************************************************************/
+void waitForKeys(int milliseconds, struct runControl *control)
+{
+    double end = getTime() + milliseconds / 1000.0;
+    int slice;
+
+    // Wait in short slices, frame server viewers are served between them
+    while (milliseconds > 0)
+    {
+        serveViewers();
+        slice = milliseconds < 1000 / REDRAW_HZ ? milliseconds : 1000 / REDRAW_HZ;
+
+        #ifdef HAVE_NCURSES_H
+        int key;
+
+        // getch() waits at most 'slice'
+        timeout(slice);
+        key = getch();
+        nodelay(stdscr, TRUE);
+
+        if (key != ERR)
+        {
+            handleKey(key, control);
+            return;
+        }
+        #else
+        delay(slice);
+        #endif
+
+        milliseconds = (int)((end - getTime()) * 1000);
+    }
+}
+
+/*********************************************************************
+ NAME: handleKey
+ DESCRIPTION: Changes run controls according to pressed key
+	Input: key, control
+	Output: -
+  Used global variables: render_mode
+ REMARKS when using this function: space/p = pause, s = single step, + = faster, - = slower,
+                                    r = change render mode, q = quit
+*********************************************************************/
+void handleKey(int key, struct runControl *control)
+{
+    switch (key)
+    {
+        case ' ':
+        case 'p':
+            control->paused = !control->paused;
+            break;
+        case 's':
+            // Stepping pauses the game
+            control->paused = true;
+            control->step = true;
+            break;
+        case '+':
+        case '=':
+            control->delay_time /= 2;
+            break;
+        case '-':
+            control->delay_time = control->delay_time ? control->delay_time * 2 : 1;
+            if (control->delay_time > MAX_DELAY)
+                control->delay_time = MAX_DELAY;
+            break;
+        case 'r':
+            render_mode = (render_mode + 1) % 4;
+            break;
+        case 'q':
+            control->quit = true;
+            break;
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ NAME: printStatus
+ DESCRIPTION: displays generation, speed and render mode below the board
+	Input: gen, control
+	Output: -
+  Used global variables: xy_size, render_mode, render_every, engine, autoselect, server
+ REMARKS when using this function: in automatic engine mode shows the engine running now and how often it switched
+*********************************************************************/
+void printStatus(int gen, const struct runControl *control)
+{
+    char mode[32], engine_name[64];
+
+    switch (render_mode)
+    {
+        case RENDER_NTH:
+            sprintf(mode, "every %d gen", render_every);
+            break;
+        case RENDER_FAST:
+            sprintf(mode, "fast, %d Hz", REDRAW_HZ);
+            break;
+        case RENDER_NONE:
+            sprintf(mode, "headless");
+            break;
+        default:
+            sprintf(mode, "every gen");
+            break;
+    }
+
+    if (engine == ENGINE_AUTO)
+        sprintf(engine_name, "auto: %s, %d switch%s", engine_names[autoselect.running], autoselect.switches,
+                autoselect.switches == 1 ? "" : "es");
+    else
+        sprintf(engine_name, "%s", engine_names[engine]);
+
+    #ifdef HAVE_NCURSES_H
+    mvprintw(xy_size[1] + 2, 0, "Gen %d | delay %d ms | draw %s | %s", gen, control->delay_time, mode, engine_name);
+    if (server.listen_fd >= 0)
+        printw(" | viewers %d", server.client_count);
+    if (control->paused)
+        printw(" | PAUSED");
+    clrtoeol();
+    mvprintw(xy_size[1] + 3, 0, "[space] pause [s] step [+/-] speed [r] draw mode [q] quit");
+    refresh();
+    #else
+    printf("Gen %d | delay %d ms | draw %s | %s\n", gen, control->delay_time, mode, engine_name);
+    #endif
 }
 
 /*********************************************************************
@@ -384,465 +1109,3880 @@ int countNeighbours(int cellx, int celly)
 }
 
 /*********************************************************************
- NAME: printState
- DESCRIPTION: displays/prints game state to user, and updates future state.
+ NAME: nextCellState
+ DESCRIPTION: Applies the same rules as calculateFuture() to a single cell
+	Input: alive, neighbours
+	Output: 1 = alive in next generation, 0 = dead
+  Used global variables: -
+ REMARKS when using this function: used to build engine tables, must stay in line with calculateFuture()
+*********************************************************************/
+int nextCellState(int alive, int neighbours)
+{
+    // alive cell survives with 2 or 3 neighbours
+    if (alive == 1)
+        return neighbours == 2 || neighbours == 3;
+
+    // dead cell respawns with 3 or more neighbours
+    return neighbours > 2;
+}
+
+/*********************************************************************
+ NAME: advanceState
+ DESCRIPTION: Moves board to the next state without printing it
 	Input: -
 	Output: -
-  Used global variables: xy_size
- REMARKS when using this function: Cell's future should be calculated beforehand.
+  Used global variables: xy_size, **board
+ REMARKS when using this function: same update as printState(), cell's future should be calculated beforehand.
 *********************************************************************/
-void printState()
+void advanceState(void)
 {
-    #ifdef HAVE_NCURSES_H
-    clear();
-    printw("\n");
-    #else
-    printf("\n");
-    #endif
-
     int x, y;
 
     for (y = 0; y < xy_size[1]; y++)
     {
         for (x = 0; x < xy_size[0]; x++)
         {
-            if (board[x][y].current == 1)
-            {
-                printCellState(true, board[x][y].color);
-            }
-            else
-            {
-                printCellState(false, board[x][y].color);
-            }
-            
-            // Above we print current state, and update to the next state.
             board[x][y].current = board[x][y].future;
-            // reset color
             board[x][y].color = 'd';
         }
-        #ifdef HAVE_NCURSES_H
-        printw("\n");
-        #else
-        printf("\n");
-        #endif
     }
-
-    #ifdef HAVE_NCURSES_H
-    refresh();
-    #endif
-
 }
 
 /*********************************************************************
- NAME: printCellState
- DESCRIPTION: Prints 'O' or '.' with the correct color 
-	Input: alive_or_dead, color
-	Output: -
-  Used global variables: -
- REMARKS when using this function: input cell state and color, function prints character
+ NAME: stepGeneration
+ DESCRIPTION: Calculates the future of the board with the selected engine
+	Input: render, record
+	Output: actions (how many cell's states were changed)
+  Used global variables: engine, life, life_now, **board, activity_export, server
+ REMARKS when using this function: prepareEngine() (and allocateActivity() / startServer() if they are on) should be called beforehand.
+                                    render = TRUE: board future and color are set like calculateFuture() does,
+                                    call printState() next. render = FALSE: board moves to next state
+                                    without printing (packed engines leave the board untouched).
+                                    record = FALSE: step is not added to the activity map or sent to viewers.
 *********************************************************************/
-void printCellState(bool alive_or_dead, char color) 
+int stepGeneration(bool render, bool record)
 {
-    #ifdef HAVE_NCURSES_H
-    start_color();
-
-    init_pair(1, COLOR_RED, COLOR_BLACK);
-    init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    init_pair(3, COLOR_YELLOW, COLOR_BLACK);
-
-    switch(color)
-    {
-        case 'r':
-            attron(COLOR_PAIR(1));
-            break;
-        case 'g':
-            attron(COLOR_PAIR(2));
-            break;
-        default:
-            attron(COLOR_PAIR(1));
-            break;
-    }
-
-    printw("%c", alive_or_dead ? alive_char : dead_char);
+    int actions;
 
-    #else
-    switch(color)
+    if (engine == ENGINE_REFERENCE)
     {
-        case 'r':
-            printf("%s", RED);
-            break;
-        case 'g':
-            printf("%s", GREEN);
-            break;
-        default:
-            printf("%s", RESET_COLOR);
-            break;
+        actions = calculateFuture();
+        if (record && activity_export != ACTIVITY_OFF)
+            accumulateBoard();
+        if (record && server.listen_fd >= 0)
+            publishFrame();
+        if (render == false)
+            advanceState();
+        return actions;
     }
 
-    // syntax: variable ? 'true' : 'false' || same as: if (variable == 1) .. else ..
-    printf("%c", alive_or_dead ? alive_char : dead_char);
+    actions = stepPacked(engine, &life[life_now], &life[!life_now]);
+    if (record && activity_export != ACTIVITY_OFF)
+        accumulateActivity(&life[life_now], &life[!life_now]);
+    if (record && server.listen_fd >= 0)
+        publishFrame();
+    if (render)
+        gridToBoard(&life[life_now], &life[!life_now]);
+    life_now = !life_now;
 
-    printf("%s", RESET_COLOR);
-    #endif
+    return actions;
 }
 
 /*********************************************************************
- NAME: delay
- DESCRIPTION: Adds delay with clock_t in the time.h library
-	Input: milliseconds
-	Output: -
+ NAME: allocateGrid
+ DESCRIPTION: Allocates an empty packed grid
+	Input: grid, width, height
+	Output: TRUE, FALSE
   Used global variables: -
- REMARKS when using this function: -
+ REMARKS when using this function: free with freeGrid()
 *********************************************************************/
-void delay(int milliseconds)
+bool allocateGrid(struct lifeGrid *grid, int width, int height)
 {
-    // Storing start time
-    clock_t start_time = clock();
- 
-    // looping till required time is not achieved
-    while (clock() < start_time + milliseconds);
+    grid->width = width;
+    grid->height = height;
+    grid->words = (width + 63) / 64;
+
+    // calloc: padding rows and unused bits have to start dead
+    grid->rows = (uint64_t*) calloc((size_t)(height + 3) * grid->words, sizeof(uint64_t));
+    if (grid->rows == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for %dx%d grid\n", width, height);
+        return false;
+    }
+
+    return true;
 }
 
 /*********************************************************************
- NAME: printInstructions
- DESCRIPTION: prints instructions to user
-	Input: string
+ NAME: freeGrid
+ DESCRIPTION: deallocates memory of packed grid
+	Input: grid
 	Output: -
   Used global variables: -
- REMARKS when using this function: string is passed to print corresponding instructions ("state")
+ REMARKS when using this function: deallocates memory created in allocateGrid()
 *********************************************************************/
-void printInstructions(char state[])
+void freeGrid(struct lifeGrid *grid)
 {
-    if (state == "welcome")
-    {
-        printf("What would you like to do?\n");
-        printf("%s A) Play game\n", MAGENTA);
-        printf(" B) Settings\n");
-        printf(" C) Show highscore\n");
-        printf(" H) Show this menu\n");
-        printf(" X) Exit program\n");
-    }
-    else if (state == "gameoflife")
-    {
-        printf("\nThis is the GAME OF LIFE.\n");
-        printf("The rules are simple:\n");
-        printf("%s\t- Each cell with one or no neighbours' dies, as if by loneliness.\n", YELLOW);
-        printf("\t- Each cell with four or more neighbours dies, as if by overpopulation.\n");
-        printf("\t- Each cell with two or three neighbours survives.\n");
-        printf("\t- Each cell with three neighbours becomes populated. (unpopulated spaces)%s\n", RESET_COLOR);
-        printf("Lets start?\n\n");
-    }
-    else if (state == "settings")
-    {
-        printf("\nSettings\n");
-        printf("%sA) Help!!\n", MAGENTA);
-        printf("B) Read gamestate from file\n");
-        printf("C) Paste gamestate as string\n");
-        printf("D) Randomize gamestate\n");
-        printf("X) Back%s\n\n", RESET_COLOR);
-    }
-    else if (state == "settingshelp")
-    {
-        printf("%sB) Read gamestate from file\n", MAGENTA);
-        printf("\t%s- use: file longest column = board column, file rows = board rows\n", YELLOW);
-        printf("\t- cell state: The most occured character = dead, second most occured = alive\n");
-        printf("\t\t- NOTE: default to 'o' = alive, '.' = dead, if they are the most/2most occured\n\n%s", MAGENTA);
-        printf("C) Paste gamestate as string\n");
-        printf("\t%s- use: paste string with ctrl+v or shift+insert\n", YELLOW);
-        printf("\t- Format: (note: end with 'e')\n");
-        printf("\t  ....o\n");
-        printf("\t  .oo..\n");
-        printf("\t  .....%s\n\n", MAGENTA);
-        printf("D) Randomize gamestate\n");
-        printf("\t%s- This will generate a random size. Delay time default is 500ms / 0.5s\n\n", YELLOW);
-        printf("%sX) Go back to previous menu%s\n", MAGENTA, RESET_COLOR);
-        
-    }
+    free(grid->rows);
+    grid->rows = NULL;
 }
 
 /*********************************************************************
- NAME: allocateMemory
- DESCRIPTION: Dynamically allocates memory for global: struct cell and xy_size
-	Input: 
+ NAME: boardToGrid
+ DESCRIPTION: Copies current state of the board to packed grid
+	Input: grid
 	Output: -
-  Used global variables: xy_size, **board, alive_cells
- REMARKS when using this function: takes size of the board as arguments, and uses malloc to initialize/set each value
+  Used global variables: xy_size, **board
+ REMARKS when using this function: grid should be allocated with xy_size beforehand
 *********************************************************************/
-bool allocateMemory()
+void boardToGrid(struct lifeGrid *grid)
 {
-    // Check that x and y values fall between a certain range.
-    if (xy_size[0] < 1 || xy_size[1] < 1 || xy_size[0] > 100 || xy_size[1] > 100)
-        return false;
-
-    int i, j;
-
-    // Allocate memory for the board columns. Size * struct cell size
-    board = (struct cell**) malloc(xy_size[0] * sizeof(struct cell*));
+    int x, y;
 
-    // Handle error
-    if (board == NULL) 
+    for (y = 0; y < xy_size[1]; y++)
     {
-        // stderr could be replaced by pointer to file pointer, to write to a file.
-        // It uses a different stream (not input stream). However since its set as "stderr" it writes to console
-        fprintf(stderr, "Error: Failed to allocate memory for board\n");
-        return false;
-    }
+        uint64_t *row = GRID_ROW(grid, y);
 
-    // Iterate through rows
-    for (int i = 0; i < xy_size[0]; i++) 
-    {
-        // allocate memory
-        board[i] = (struct cell*) malloc(xy_size[1] * sizeof(struct cell));
-        // Handle error
-        if (board[i] == NULL) 
+        memset(row, 0, grid->words * sizeof(uint64_t));
+        for (x = 0; x < xy_size[0]; x++)
         {
-            fprintf(stderr, "Error: Failed to allocate memory for board[%d]\n", i); 
-            return false;
+            if (board[x][y].current == 1)
+                row[x / 64] |= (uint64_t)1 << (x % 64);
         }
     }
+}
 
-    // Initialize the board
-    for (int i = 0; i < xy_size[1]; i++) 
+/*********************************************************************
+ NAME: gridToBoard
+ DESCRIPTION: Sets board current, future and color from two packed generations
+	Input: now, next
+	Output: -
+  Used global variables: xy_size, **board
+ REMARKS when using this function: colors are set like calculateFuture() does: 'r' = dies, 'g' = alive in future
+*********************************************************************/
+void gridToBoard(const struct lifeGrid *now, const struct lifeGrid *next)
+{
+    int x, y;
+
+    for (y = 0; y < xy_size[1]; y++)
     {
-        for (int j = 0; j < xy_size[0]; j++) 
+        const uint64_t *row_now = GRID_ROW(now, y);
+        const uint64_t *row_next = GRID_ROW(next, y);
+
+        for (x = 0; x < xy_size[0]; x++)
         {
-            if (alive_cells[j][i] == 1)
-                board[j][i].current = 1;
-            else
-                board[j][i].current = 0;
+            board[x][y].current = (row_now[x / 64] >> (x % 64)) & 1;
+            board[x][y].future = (row_next[x / 64] >> (x % 64)) & 1;
 
-            // Allocate for each other parameter too.
-            board[j][i].future = 0;
-            board[j][i].color = 'd';
+            if (board[x][y].future == 1)
+                board[x][y].color = 'g'; // green
+            else if (board[x][y].current == 1)
+                board[x][y].color = 'r'; // red
         }
     }
-
-    return true;
 }
 
 /*********************************************************************
- NAME: deAllocateMemory
- DESCRIPTION: deallocates memory
+ NAME: prepareEngine
+ DESCRIPTION: Initializes the selected engine from the board
 	Input: -
-	Output: -
-  Used global variables: xy_size, **board
- REMARKS when using this function: deallocates memory created in allocateMemory()
+	Output: TRUE, FALSE
+  Used global variables: engine, life, life_now, xy_size
+ REMARKS when using this function: board should be initialized beforehand, release with releaseEngine()
 *********************************************************************/
-void deAllocateMemory(void)
+bool prepareEngine(void)
 {
-    int i;
+    if (engine == ENGINE_REFERENCE)
+        return true;
 
-    /* Free memory for board */
-    for (i = 0; i < xy_size[0]; i++) 
+    if (block_table_ready == false)
+        buildBlockTable();
+
+    if (allocateGrid(&life[0], xy_size[0], xy_size[1]) == false)
+        return false;
+    if (allocateGrid(&life[1], xy_size[0], xy_size[1]) == false || allocateSparse(xy_size[0], xy_size[1]) == false)
     {
-        free(board[i]);
+        freeGrid(&life[0]);
+        freeGrid(&life[1]);
+        return false;
     }
-    free(board);
 
+    life_now = 0;
+    boardToGrid(&life[life_now]);
+    resetAuto();
+
+    return true;
 }
 
 /*********************************************************************
- NAME: clear_input_buffer
- DESCRIPTION: clears the input buffer 
-	Input:  -
+ NAME: releaseEngine
+ DESCRIPTION: deallocates memory of the selected engine
+	Input: -
 	Output: -
-  Used global variables: -
- REMARKS when using this function: only clears until \n or EOF ("12 2 \n 23" -> " 23" will be left in input buffer)
+  Used global variables: engine, life
+ REMARKS when using this function: deallocates memory created in prepareEngine()
 *********************************************************************/
-void clear_input_buffer(void)
+void releaseEngine(void)
 {
-  int c;
-  do {
-    c = getchar();
-  } while (c != '\n' && c != EOF);
+    if (engine == ENGINE_REFERENCE)
+        return;
+
+    freeGrid(&life[0]);
+    freeGrid(&life[1]);
+    freeSparse();
 }
 
 /*********************************************************************
- NAME: modifySettings()
- DESCRIPTION: 
-	Input: 
+ NAME: buildBlockTable
+ DESCRIPTION: Fills block_table with the next state of every possible 4x4 block
+	Input: -
 	Output: -
-  Used global variables: -
- REMARKS when using this function: -
+  Used global variables: block_table, block_table_ready
+ REMARKS when using this function: index bit (y * 4 + x) = cell x, y of the 4x4 block.
+                                    Result bit (y * 2 + x) = centre cell x + 1, y + 1.
 *********************************************************************/
-void modifySettings(void)
+void buildBlockTable(void)
 {
-    printInstructions("settings");
-    char command;
-    do 
+    int index, cx, cy, x, y, count;
+
+    for (index = 0; index < 65536; index++)
     {
-        command = ask_command();
-        
-        switch (command) 
-        {
-            case 'A': // HELP
-                printInstructions("settingshelp");
-                break;
-            case 'B': // READ FILE
-                if (readGameFromFile() == 1)
-                    printf("%sFile read and game initialized *thumbs up*", GREEN);
-                else
-                    printf("%sSomething went wrong :(%s", RED, RESET_COLOR);
-                break;
-            case 'C': // MANUAL
+        unsigned char result = 0;
 
-                break;
-            case 'D': // RANDOMIZE
+        // Centre cells of the block are (1,1) (2,1) (1,2) (2,2), all their neighbours are inside the block
+        for (cy = 1; cy <= 2; cy++)
+        {
+            for (cx = 1; cx <= 2; cx++)
+            {
+                count = 0;
+                for (y = cy - 1; y <= cy + 1; y++)
+                {
+                    for (x = cx - 1; x <= cx + 1; x++)
+                    {
+                        if ((x != cx || y != cy) && ((index >> (y * 4 + x)) & 1))
+                            count++;
+                    }
+                }
 
-                break;
-            case '?': // INPUT BUFFER EXCEEDED
-                printf("%sInput buffer exceeded. Please try again.", RED);
-                break;
-            case 'X': // EXIT
-                printf("Bye :)");
-                break;
-            default: // INVALID COMMAND
-                printf("%sInvalid command. Please try again.", RED);
-                break;
+                if (nextCellState((index >> (cy * 4 + cx)) & 1, count))
+                    result |= 1 << ((cy - 1) * 2 + (cx - 1));
+            }
         }
+        block_table[index] = result;
+    }
 
-        printf("%s", RESET_COLOR);
-        printf("\n");
-
-    } while (command != 'X');
+    block_table_ready = true;
 }
 
 /*********************************************************************
- NAME: readGameFromFile
- DESCRIPTION: Reads board state and size from file
-	Input: -
-	Output: TRUE, FALSE
-  Used global variables: xy_size, alive_cells
- REMARKS when using this function: Default to: alive char 'o', dead char '.', if they appear in file.
-                                    Else most frequent character = alive, 2most = dead.
-                                    x size = longest line on file, y size = number of rows in file
+ NAME: stepBlockTable
+ DESCRIPTION: Calculates next generation 2x2 cells at a time with block_table
+	Input: now, next
+	Output: actions (how many cell's states were changed)
+  Used global variables: block_table
+ REMARKS when using this function: buildBlockTable() should be called beforehand. No SIMD needed,
+                                    one table lookup replaces four neighbour counts.
 *********************************************************************/
-bool readGameFromFile(void)
+int stepBlockTable(const struct lifeGrid *now, struct lifeGrid *next)
 {
-    FILE *file;
+    int y, w, r, j, actions = 0;
+    int words = now->words;
+    uint64_t last_mask = lastWordMask(now);
 
-    // Ask for filename
-    char filename[100];
-    fgets(filename, 100, stdin);
-    if (strchr(filename, '\n') != NULL)
-        filename[strcspn(filename, "\n")] = '\0';
+    // Each pass makes rows y and y + 1, reading rows y - 1 ... y + 2
+    for (y = 0; y < now->height; y += 2)
+    {
+        const uint64_t *in[4] = {GRID_ROW(now, y - 1), GRID_ROW(now, y), GRID_ROW(now, y + 1), GRID_ROW(now, y + 2)};
+        uint64_t *out_top = GRID_ROW(next, y);
+        uint64_t *out_bottom = GRID_ROW(next, y + 1);
+        bool has_bottom = y + 1 < now->height;
 
-    // Read from file and check for error
-    file = fopen(filename, "r");
-    if (file == NULL)
+        for (w = 0; w < words; w++)
+        {
+            uint64_t window[4], top = 0, bottom = 0;
+            unsigned edge[4], index, result;
+
+            // window bit i = cell (64 * w - 1 + i), edge = cells 64 * w + 63 and 64 * w + 64
+            for (r = 0; r < 4; r++)
+            {
+                uint64_t left = w > 0 ? in[r][w - 1] : 0;
+                uint64_t right = w + 1 < words ? in[r][w + 1] : 0;
+
+                window[r] = (in[r][w] << 1) | (left >> 63);
+                edge[r] = (unsigned)((in[r][w] >> 63) | ((right & 1) << 1));
+            }
+
+            // 31 blocks fit in the window
+            for (j = 0; j < 62; j += 2)
+            {
+                index = (unsigned)((window[0] & 0xF) | (window[1] & 0xF) << 4 | (window[2] & 0xF) << 8 | (window[3] & 0xF) << 12);
+                result = block_table[index];
+                top |= (uint64_t)(result & 3) << j;
+                bottom |= (uint64_t)(result >> 2) << j;
+
+                for (r = 0; r < 4; r++)
+                    window[r] >>= 2;
+            }
+
+            // Last block needs two cells from the edge
+            index = 0;
+            for (r = 0; r < 4; r++)
+                index |= (unsigned)(window[r] | edge[r] << 2) << (r * 4);
+            result = block_table[index];
+            top |= (uint64_t)(result & 3) << 62;
+            bottom |= (uint64_t)(result >> 2) << 62;
+
+            // Cells right of the board stay dead
+            if (w == words - 1)
+            {
+                top &= last_mask;
+                bottom &= last_mask;
+            }
+
+            out_top[w] = top;
+            actions += popcount64(top ^ in[1][w]);
+
+            // Row below an odd height board is padding
+            if (has_bottom)
+            {
+                out_bottom[w] = bottom;
+                actions += popcount64(bottom ^ in[2][w]);
+            }
+        }
+    }
+
+    return actions;
+}
+
+/*********************************************************************
+ NAME: popcount64
+ DESCRIPTION: Counts set bits in 64-bit word
+	Input: word
+	Output: count
+  Used global variables: -
+ REMARKS when using this function: -
+*********************************************************************/
+int popcount64(uint64_t word)
+{
+    #if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+    #else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+    #endif
+}
+
+/*********************************************************************
+ NAME: lastWordMask
+ DESCRIPTION: Returns mask of the cells inside the board in the last word of a row
+	Input: grid
+	Output: mask
+  Used global variables: -
+ REMARKS when using this function: -
+*********************************************************************/
+uint64_t lastWordMask(const struct lifeGrid *grid)
+{
+    return (grid->width % 64) ? ((uint64_t)1 << (grid->width % 64)) - 1 : ~(uint64_t)0;
+}
+
+/*********************************************************************
+ NAME: nextLifeWord
+ DESCRIPTION: Calculates next state of 64 cells at once
+	Input: up, mid, down, w, words
+	Output: next state of word w of row mid
+  Used global variables: -
+ REMARKS when using this function: up/down = rows above and below mid. Bits right of the board are not masked.
+*********************************************************************/
+uint64_t nextLifeWord(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int w, int words)
+{
+    const uint64_t *rows[3] = {up, mid, down};
+    uint64_t before[3], centre[3], after[3];
+    int r;
+
+    for (r = 0; r < 3; r++)
     {
-        printf("%sError opening file:%s %s", RED, RESET_COLOR, filename);
-        return false;
+        before[r] = w > 0 ? rows[r][w - 1] : 0;
+        centre[r] = rows[r][w];
+        after[r] = w + 1 < words ? rows[r][w + 1] : 0;
     }
 
-    // Check file extension .txt only
-    char *ext = strrchr(filename, '.');
-    if (strcmp(ext, ".txt") != 0) {
-        printf("Only txt files are allowed\n");
-        return 0;
+    return lifeBits(before, centre, after);
+}
+
+/*********************************************************************
+ NAME: lifeBits
+ DESCRIPTION: Calculates next state of the 64 cells in centre[1]
+	Input: before, centre, after
+	Output: next state of centre[1]
+  Used global variables: -
+ REMARKS when using this function: [0] = row above, [1] = own row, [2] = row below. before/after = words left
+                                    and right of centre, 0 at the board edge. Neighbours are added with
+                                    bitwise full adders, so each bit position counts its own cell.
+*********************************************************************/
+uint64_t lifeBits(const uint64_t *before, const uint64_t *centre, const uint64_t *after)
+{
+    uint64_t left[3], right[3], carry_a, carry_b, carry_c, carry_d, carry_e, carry_f;
+    uint64_t sum_a, sum_b, sum_c, sum_e, ones, twos, fours, eights;
+    int r;
+
+    // left: bit x = cell x - 1, right: bit x = cell x + 1
+    for (r = 0; r < 3; r++)
+    {
+        left[r] = (centre[r] << 1) | (before[r] >> 63);
+        right[r] = (centre[r] >> 1) | (after[r] << 63);
     }
-    
-    // y = rows, x = line lenght, buffer = line content, filecontent = {row}{content}
-    int ascii[256] = {0};
-    int rows = 0, i = 0, x = 0;
-    char filecontent[100][100] = {0};
-    char c;
 
-    // Read file character by character
-    while ((c = fgetc(file)) != EOF)
+    // Add the 8 neighbours in groups of three, sum = weight 1, carry = weight 2
+    sum_a = left[0] ^ centre[0] ^ right[0];
+    carry_a = (left[0] & centre[0]) | (right[0] & (left[0] ^ centre[0]));
+    sum_b = left[1] ^ right[1] ^ left[2];
+    carry_b = (left[1] & right[1]) | (left[2] & (left[1] ^ right[1]));
+    sum_c = centre[2] ^ right[2];
+    carry_c = centre[2] & right[2];
+
+    ones = sum_a ^ sum_b ^ sum_c;
+    carry_d = (sum_a & sum_b) | (sum_c & (sum_a ^ sum_b));
+
+    // Weight 2 carries, carry_e and carry_f = weight 4
+    sum_e = carry_a ^ carry_b ^ carry_c;
+    carry_e = (carry_a & carry_b) | (carry_c & (carry_a ^ carry_b));
+    twos = sum_e ^ carry_d;
+    carry_f = sum_e & carry_d;
+    fours = carry_e ^ carry_f;
+    eights = carry_e & carry_f;
+
+    // Same rules as calculateFuture(): alive survives with 2 or 3, dead respawns with 3 or more
+    return (centre[1] & twos & ~(fours | eights)) | (~centre[1] & ((ones & twos) | fours | eights));
+}
+
+/*********************************************************************
+ NAME: stepDense
+ DESCRIPTION: Calculates next generation 64 cells at a time
+	Input: now, next
+	Output: actions (how many cell's states were changed)
+  Used global variables: -
+ REMARKS when using this function: every word of the board is calculated, best when most of the board is active.
+                                    Boards listed in FIXED_SIZES are calculated with their own kernel.
+*********************************************************************/
+int stepDense(const struct lifeGrid *now, struct lifeGrid *next)
+{
+    #define X(W, H) if (now->width == W && now->height == H) return stepFixed##W##x##H(now, next);
+    FIXED_SIZES
+    #undef X
+
+    return stepDenseRows(now, next, 0, now->height);
+}
+
+/*********************************************************************
+ NAME: stepDenseGeneric
+ DESCRIPTION: Steps whole grid with stepDenseRows(), also on sizes that have a fixed size kernel
+	Input: now, next
+	Output: actions
+  Used global variables: -
+ REMARKS when using this function: baseline of benchmarkFixed()
+*********************************************************************/
+int stepDenseGeneric(const struct lifeGrid *now, struct lifeGrid *next)
+{
+    return stepDenseRows(now, next, 0, now->height);
+}
+
+/*********************************************************************
+ NAME: stepDenseRows
+ DESCRIPTION: Calculates next generation of rows y_begin ... y_end - 1, 64 cells at a time
+	Input: now, next, y_begin, y_end
+	Output: actions (how many cell's states were changed)
+  Used global variables: -
+ REMARKS when using this function: rows can be calculated by different threads at the same time
+*********************************************************************/
+int stepDenseRows(const struct lifeGrid *now, struct lifeGrid *next, int y_begin, int y_end)
+{
+    int y, w, actions = 0, words = now->words;
+    uint64_t last_mask = lastWordMask(now);
+
+    for (y = y_begin; y < y_end; y++)
     {
-        // Add this character to the file content array
-        filecontent[i][rows] = c;
+        const uint64_t *up = GRID_ROW(now, y - 1), *mid = GRID_ROW(now, y), *down = GRID_ROW(now, y + 1);
+        uint64_t *out = GRID_ROW(next, y);
 
-        // Check each line
-        if (c == '\n')
+        for (w = 0; w < words; w++)
         {
-            // Check if this is the longest row so far
-            if (i > x)
-                x = i;
+            uint64_t cells = nextLifeWord(up, mid, down, w, words);
 
-            i = 0;
-            rows++;
-        }
-        else
-        {
-            // Increment count for this ASCII character, and i (line character count)
-            ascii[c]++;
-            i++;
+            // Cells right of the board stay dead
+            if (w == words - 1)
+                cells &= last_mask;
+
+            actions += popcount64(cells ^ mid[w]);
+            out[w] = cells;
         }
     }
 
-    // add last line and check if last line is longest
-    rows++;
-    if (i > x)
-        x = i;
+    return actions;
+}
 
-    fclose(file);
+/*********************************************************************
+ NAME: FIXED_KERNEL
+ DESCRIPTION: Defines stepFixedWxH(), stepDenseRows() for a board of exactly W x H cells
+	Input: W, H
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: One kernel is defined for every size in FIXED_SIZES. Stride, row count
+                                    and edge mask are constants, the word loop has no edge checks: the left
+                                    and right words slide along the row and the last word is done apart.
+                                    Word loop is fully unrolled (UNROLL_FULLY) for rows of up to 65 words.
+*********************************************************************/
+#define FIXED_KERNEL(W, H)                                                                           \
+int stepFixed##W##x##H(const struct lifeGrid *now, struct lifeGrid *next)                          \
+{                                                                                                    \
+    enum { WORDS = ((W) + 63) / 64 };                                                                \
+    const uint64_t last_mask = ((W) % 64) ? ((uint64_t)1 << ((W) % 64)) - 1 : ~(uint64_t)0;         \
+    const uint64_t *src = now->rows;                                                                 \
+    uint64_t *dst = next->rows + WORDS;                                                              \
+    uint64_t before[3], centre[3], after[3], cells;                                                  \
+    int y, w, actions = 0;                                                                           \
+                                                                                                     \
+    /* src = row above, src + WORDS = own row, src + 2 * WORDS = row below */                       \
+    for (y = 0; y < (H); y++, src += WORDS, dst += WORDS)                                            \
+    {                                                                                                \
+        before[0] = before[1] = before[2] = 0;                                                       \
+        centre[0] = src[0];                                                                          \
+        centre[1] = src[WORDS];                                                                      \
+        centre[2] = src[2 * WORDS];                                                                  \
+                                                                                                     \
+        UNROLL_FULLY                                                                                 \
+        for (w = 0; w < WORDS - 1; w++)                                                              \
+        {                                                                                            \
+            after[0] = src[w + 1];                                                                   \
+            after[1] = src[WORDS + w + 1];                                                           \
+            after[2] = src[2 * WORDS + w + 1];                                                       \
+            cells = lifeBits(before, centre, after);                                                 \
+            actions += popcount64(cells ^ centre[1]);                                                \
+            dst[w] = cells;                                                                          \
+            before[0] = centre[0], before[1] = centre[1], before[2] = centre[2];                     \
+            centre[0] = after[0], centre[1] = after[1], centre[2] = after[2];                        \
+        }                                                                                            \
+                                                                                                     \
+        /* Last word: nothing on the right, cells right of the board stay dead */                    \
+        after[0] = after[1] = after[2] = 0;                                                          \
+        cells = lifeBits(before, centre, after) & last_mask;                                         \
+        actions += popcount64(cells ^ centre[1]);                                                    \
+        dst[WORDS - 1] = cells;                                                                      \
+    }                                                                                                \
+                                                                                                     \
+    return actions;                                                                                  \
+}
 
-    int max = 0, max2 = 0, j;
-    char most_character, most_character2;
+#define X(W, H) FIXED_KERNEL(W, H)
+FIXED_SIZES
+#undef X
 
-    // Iterate through ASCII range
-    for (i = 0; i < 256; i++)
+/*********************************************************************
+ NAME: allocateSparse
+ DESCRIPTION: Allocates tile flags of the sparse engine, all tiles active
+	Input: width, height
+	Output: TRUE, FALSE
+  Used global variables: sparse
+ REMARKS when using this function: free with freeSparse()
+*********************************************************************/
+bool allocateSparse(int width, int height)
+{
+    sparse.tiles_x = (width + 63) / 64;
+    sparse.tiles_y = (height + SPARSE_TILE_ROWS - 1) / SPARSE_TILE_ROWS;
+    sparse.active = (unsigned char*) malloc((size_t)sparse.tiles_x * sparse.tiles_y);
+    sparse.next_active = (unsigned char*) malloc((size_t)sparse.tiles_x * sparse.tiles_y);
+
+    if (sparse.active == NULL || sparse.next_active == NULL)
     {
-        // look at each ASCII character (ascii[i]), and check which has the highest value (= which occured the most) 
-        // Also don't count newlines
-        if (ascii[i] > max && ascii[i] != '\n')
-        {
-            max = ascii[i];
-            most_character = (char)i;
-        }
-        // If it wasn't the highest value, check for 2nd highest value
-        else if (ascii[i] > max2)
-        {
-            max2 = ascii[i];
-            most_character2 = (char)i;
-        }
+        fprintf(stderr, "Error: Failed to allocate memory for sparse tiles\n");
+        freeSparse();
+        return false;
     }
 
-    // Set global characters to file most and second most read characters
-    alive_char = (char)most_character;
-    dead_char = (char)most_character2;
-    xy_size[0] = x;
-    xy_size[1] = rows;
+    resetSparse();
 
-    printf("Board x: %d\n", x);
-    printf("Board y: %d\n", rows);
-    
-    // default to 'o' = alive, '.' = dead, if . / o / O appear in file
-    if (most_character == '.' || most_character == 'o' || most_character == 'O' ||
-    most_character2 == '.' || most_character2 == 'o' || most_character2 == 'O') 
+    return true;
+}
+
+/*********************************************************************
+ NAME: freeSparse
+ DESCRIPTION: deallocates tile flags of the sparse engine
+	Input: -
+	Output: -
+  Used global variables: sparse
+ REMARKS when using this function: deallocates memory created in allocateSparse()
+*********************************************************************/
+void freeSparse(void)
+{
+    free(sparse.active);
+    free(sparse.next_active);
+    sparse.active = NULL;
+    sparse.next_active = NULL;
+}
+
+/*********************************************************************
+ NAME: resetSparse
+ DESCRIPTION: Marks every tile active
+	Input: -
+	Output: -
+  Used global variables: sparse
+ REMARKS when using this function: call when grids were stepped by another engine, next step calculates the whole board
+*********************************************************************/
+void resetSparse(void)
+{
+    memset(sparse.active, 1, (size_t)sparse.tiles_x * sparse.tiles_y);
+}
+
+/*********************************************************************
+ NAME: stepSparse
+ DESCRIPTION: Calculates next generation only in tiles that changed or are next to a change
+	Input: now, next
+	Output: actions (how many cell's states were changed)
+  Used global variables: sparse
+ REMARKS when using this function: allocateSparse() should be called beforehand. Tile = 64 columns x SPARSE_TILE_ROWS rows.
+                                    A tile with no change around it last generation is the same in now and next,
+                                    so it is skipped without copying.
+*********************************************************************/
+int stepSparse(const struct lifeGrid *now, struct lifeGrid *next)
+{
+    int tx, ty, y, y_end, dx, dy, actions = 0, words = now->words;
+    uint64_t last_mask = lastWordMask(now);
+    unsigned char *swap;
+
+    memset(sparse.next_active, 0, (size_t)sparse.tiles_x * sparse.tiles_y);
+
+    for (ty = 0; ty < sparse.tiles_y; ty++)
     {
-        most_character = 'o';
-        alive_char = 'o';
-        dead_char = '.';
-        printf("Alive character defaulted to: o\n");
-        printf("Dead character defaulted to: .\n");
+        y_end = (ty + 1) * SPARSE_TILE_ROWS < now->height ? (ty + 1) * SPARSE_TILE_ROWS : now->height;
+
+        for (tx = 0; tx < sparse.tiles_x; tx++)
+        {
+            uint64_t changed = 0;
+
+            if (sparse.active[ty * sparse.tiles_x + tx] == 0)
+                continue;
+
+            for (y = ty * SPARSE_TILE_ROWS; y < y_end; y++)
+            {
+                const uint64_t *mid = GRID_ROW(now, y);
+                uint64_t cells = nextLifeWord(GRID_ROW(now, y - 1), mid, GRID_ROW(now, y + 1), tx, words);
+
+                if (tx == words - 1)
+                    cells &= last_mask;
+
+                changed |= cells ^ mid[tx];
+                actions += popcount64(cells ^ mid[tx]);
+                GRID_ROW(next, y)[tx] = cells;
+            }
+
+            // Change can reach every neighbour tile next generation
+            if (changed != 0)
+            {
+                for (dy = -1; dy <= 1; dy++)
+                    for (dx = -1; dx <= 1; dx++)
+                        if (ty + dy >= 0 && ty + dy < sparse.tiles_y && tx + dx >= 0 && tx + dx < sparse.tiles_x)
+                            sparse.next_active[(ty + dy) * sparse.tiles_x + tx + dx] = 1;
+            }
+        }
     }
-    else
+
+    swap = sparse.active;
+    sparse.active = sparse.next_active;
+    sparse.next_active = swap;
+
+    return actions;
+}
+
+/*********************************************************************
+ NAME: allocateTemporal
+ DESCRIPTION: Allocates scratch tiles of temporal blocking
+	Input: scratch, max_k
+	Output: TRUE, FALSE
+  Used global variables: -
+ REMARKS when using this function: tiles can be used for any k up to max_k. Free with freeTemporal()
+*********************************************************************/
+bool allocateTemporal(struct temporalScratch *scratch, int max_k)
+{
+    size_t words = (size_t)(TEMPORAL_TILE_ROWS + 2 * max_k) * (TEMPORAL_TILE_WORDS + 2);
+
+    scratch->max_k = max_k;
+    scratch->tile[0] = (uint64_t*) malloc(words * sizeof(uint64_t));
+    scratch->tile[1] = (uint64_t*) malloc(words * sizeof(uint64_t));
+    if (scratch->tile[0] == NULL || scratch->tile[1] == NULL)
     {
-        printf("Alive character is: %c\n", most_character);
-        printf("Dead character is: %c\n", most_character2);
+        fprintf(stderr, "Error: Failed to allocate memory for temporal tile\n");
+        freeTemporal(scratch);
+        return false;
     }
 
-    
-    // Row
-    for (i = 0; i < rows; i++)
+    return true;
+}
+
+/*********************************************************************
+ NAME: freeTemporal
+ DESCRIPTION: deallocates scratch tiles of temporal blocking
+	Input: scratch
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: deallocates memory created in allocateTemporal()
+*********************************************************************/
+void freeTemporal(struct temporalScratch *scratch)
+{
+    free(scratch->tile[0]);
+    free(scratch->tile[1]);
+    scratch->tile[0] = NULL;
+    scratch->tile[1] = NULL;
+}
+
+/*********************************************************************
+ NAME: stepTemporal
+ DESCRIPTION: Calculates k generations at once, one cache sized tile at a time
+	Input: now, next, k, scratch
+	Output: cells that are different after k generations
+  Used global variables: -
+ REMARKS when using this function: next = generation n + k. See stepTemporalRows()
+*********************************************************************/
+int stepTemporal(const struct lifeGrid *now, struct lifeGrid *next, int k, struct temporalScratch *scratch)
+{
+    return stepTemporalRows(now, next, k, 0, now->height, scratch);
+}
+
+/*********************************************************************
+ NAME: stepTemporalRows
+ DESCRIPTION: Calculates k generations of rows y_begin ... y_end - 1 at once, one cache sized tile at a time
+	Input: now, next, k, y_begin, y_end, scratch
+	Output: cells that are different after k generations, -1 if k is too large
+  Used global variables: -
+ REMARKS when using this function: next = generation n + k. Each TEMPORAL_TILE_ROWS x TEMPORAL_TILE_WORDS tile is
+                                    loaded with k halo rows and one halo word on each side, stepped k times in
+                                    scratch memory and written back, so the board goes through memory once per
+                                    k generations. Halo is calculated again by every tile that needs it, also from
+                                    rows of other threads, so rows can be calculated by different threads at the same time.
+                                    k must be 1 ... scratch->max_k (at most TEMPORAL_MAX_K).
+*********************************************************************/
+int stepTemporalRows(const struct lifeGrid *now, struct lifeGrid *next, int k, int y_begin, int y_end,
+                     struct temporalScratch *scratch)
+{
+    int rows = TEMPORAL_TILE_ROWS + 2 * k, words = TEMPORAL_TILE_WORDS + 2;
+    int tile_y, tile_w, r, w, g, gy, gw, actions = 0;
+    uint64_t column_mask[TEMPORAL_TILE_WORDS + 2], last_mask = lastWordMask(now);
+
+    if (k < 1 || k > scratch->max_k || k > TEMPORAL_MAX_K)
+        return -1;
+
+    for (tile_y = y_begin; tile_y < y_end; tile_y += TEMPORAL_TILE_ROWS)
     {
-        // column
-        for (j = 0; j < x; j++)
+        for (tile_w = 0; tile_w < now->words; tile_w += TEMPORAL_TILE_WORDS)
         {
-            // Set alive states to corresponding positions
-            if (filecontent[j][i] == most_character)
+            // Scratch row r = board row tile_y - k + r, scratch word w = board word tile_w - 1 + w
+            for (w = 0; w < words; w++)
             {
-                alive_cells[j][i] = 1;
+                gw = tile_w - 1 + w;
+                column_mask[w] = (gw < 0 || gw >= now->words) ? 0 : (gw == now->words - 1 ? last_mask : ~(uint64_t)0);
             }
-            else
+
+            for (r = 0; r < rows; r++)
             {
-                alive_cells[j][i] = 0;
+                gy = tile_y - k + r;
+                for (w = 0; w < words; w++)
+                    scratch->tile[0][r * words + w] = (gy < 0 || gy >= now->height || column_mask[w] == 0) ? 0 :
+                                                GRID_ROW(now, gy)[tile_w - 1 + w];
             }
-        }
-    }
 
-    return true;
+            // Each generation the correct area shrinks by one row and one cell on every side
+            for (g = 1; g <= k; g++)
+            {
+                const uint64_t *src = scratch->tile[(g - 1) & 1];
+                uint64_t *dst = scratch->tile[g & 1];
+
+                for (r = g; r < rows - g; r++)
+                {
+                    gy = tile_y - k + r;
+                    for (w = 0; w < words; w++)
+                    {
+                        // Cells outside the board stay dead
+                        if (gy < 0 || gy >= now->height)
+                            dst[r * words + w] = 0;
+                        else
+                            dst[r * words + w] = nextLifeWord(src + (r - 1) * words, src + r * words, src + (r + 1) * words, w, words) & column_mask[w];
+                    }
+                }
+            }
+
+            // Write back the tile without halo
+            for (r = k; r < k + TEMPORAL_TILE_ROWS && tile_y - k + r < y_end; r++)
+            {
+                const uint64_t *src = scratch->tile[k & 1] + r * words;
+                const uint64_t *old = GRID_ROW(now, tile_y - k + r);
+                uint64_t *out = GRID_ROW(next, tile_y - k + r);
+
+                for (w = 1; w <= TEMPORAL_TILE_WORDS && tile_w - 1 + w < now->words; w++)
+                {
+                    out[tile_w - 1 + w] = src[w];
+                    actions += popcount64(src[w] ^ old[tile_w - 1 + w]);
+                }
+            }
+        }
+    }
+
+    return actions;
+}
+
+/*********************************************************************
+ NAME: stepPacked
+ DESCRIPTION: Calculates next generation of packed grid with given engine
+	Input: type, now, next
+	Output: actions (how many cell's states were changed)
+  Used global variables: -
+ REMARKS when using this function: type should not be ENGINE_REFERENCE
+*********************************************************************/
+int stepPacked(enum engine_type type, const struct lifeGrid *now, struct lifeGrid *next)
+{
+    switch (type)
+    {
+        case ENGINE_TABLE:
+            return stepBlockTable(now, next);
+        case ENGINE_SPARSE:
+            return stepSparse(now, next);
+        case ENGINE_AUTO:
+            return stepAuto(now, next);
+        default:
+            return stepDense(now, next);
+    }
+}
+
+/*********************************************************************
+ NAME: resetAuto
+ DESCRIPTION: Starts automatic engine selection from the beginning
+	Input: -
+	Output: -
+  Used global variables: autoselect
+ REMARKS when using this function: first step of stepAuto() after this samples the board
+*********************************************************************/
+void resetAuto(void)
+{
+    autoselect.running = ENGINE_DENSE;
+    autoselect.generations = 0;
+    autoselect.changes = 0;
+    autoselect.switches = 0;
+    strcpy(autoselect.reason, "not sampled yet");
+}
+
+/*********************************************************************
+ NAME: stepAuto
+ DESCRIPTION: Calculates next generation with the engine chosen by sampling the board
+	Input: now, next
+	Output: actions (how many cell's states were changed)
+  Used global variables: autoselect
+ REMARKS when using this function: board is sampled every AUTO_SAMPLE_GENERATIONS generations.
+                                    All engines use the same grids, so switching does not change results.
+*********************************************************************/
+int stepAuto(const struct lifeGrid *now, struct lifeGrid *next)
+{
+    int actions;
+
+    if (autoselect.generations % AUTO_SAMPLE_GENERATIONS == 0)
+        chooseEngine(now, next);
+
+    actions = stepPacked(autoselect.running, now, next);
+    autoselect.generations++;
+    autoselect.changes += actions;
+
+    return actions;
+}
+
+/*********************************************************************
+ NAME: chooseEngine
+ DESCRIPTION: Samples population, bounding box and activity and switches engine if needed
+	Input: now, next
+	Output: -
+  Used global variables: autoselect
+ REMARKS when using this function: activity = changed cells per generation since last sample / board size.
+                                    Busy boards time dense and lookup table engines on this generation
+                                    (both write the same next state) and keep the faster one.
+                                    Every switch is written to ENGINE_LOG.
+*********************************************************************/
+void chooseEngine(const struct lifeGrid *now, struct lifeGrid *next)
+{
+    long population = 0, cells = (long)now->width * now->height;
+    long sampled = autoselect.generations % AUTO_SAMPLE_GENERATIONS ? autoselect.generations % AUTO_SAMPLE_GENERATIONS : AUTO_SAMPLE_GENERATIONS;
+    int x, y, w, min_x = now->width, max_x = -1, min_y = now->height, max_y = -1;
+    double activity, box, dense_time, table_time;
+    enum engine_type choice;
+    char reason[sizeof(autoselect.reason)];
+
+    for (y = 0; y < now->height; y++)
+    {
+        const uint64_t *row = GRID_ROW(now, y);
+
+        for (w = 0; w < now->words; w++)
+        {
+            if (row[w] == 0)
+                continue;
+
+            population += popcount64(row[w]);
+            if (y < min_y)
+                min_y = y;
+            max_y = y;
+            // lowest and highest live bit of the word
+            for (x = 0; ((row[w] >> x) & 1) == 0; x++);
+            if (w * 64 + x < min_x)
+                min_x = w * 64 + x;
+            for (x = 63; ((row[w] >> x) & 1) == 0; x--);
+            if (w * 64 + x > max_x)
+                max_x = w * 64 + x;
+        }
+    }
+
+    activity = autoselect.generations ? (double)autoselect.changes / sampled / cells : 1.0;
+    box = max_x < 0 ? 0 : (double)(max_x - min_x + 1) * (max_y - min_y + 1) / cells;
+
+    if (box < AUTO_SPARSE_BOX)
+    {
+        choice = ENGINE_SPARSE;
+        sprintf(reason, "population %ld fits in %.0f%% of board", population, box * 100);
+    }
+    else if (activity < AUTO_SPARSE_ACTIVITY)
+    {
+        choice = ENGINE_SPARSE;
+        sprintf(reason, "only %.2f%% of cells change per generation", activity * 100);
+    }
+    else
+    {
+        dense_time = timeEngine(ENGINE_DENSE, now, next);
+        table_time = timeEngine(ENGINE_TABLE, now, next);
+        choice = table_time < dense_time ? ENGINE_TABLE : ENGINE_DENSE;
+        sprintf(reason, "busy board, dense %.1f us vs lookup table %.1f us per generation", dense_time * 1e6, table_time * 1e6);
+        if (autoselect.generations > 0)
+            sprintf(reason + strlen(reason), ", %.2f%% of cells change", activity * 100);
+    }
+
+    if (choice != autoselect.running || autoselect.generations == 0)
+        logEngineSwitch(autoselect.running, choice, reason);
+
+    // Sparse tile flags are only kept up to date by the sparse engine
+    if (choice == ENGINE_SPARSE && autoselect.running != ENGINE_SPARSE)
+        resetSparse();
+
+    autoselect.running = choice;
+    autoselect.changes = 0;
+    strcpy(autoselect.reason, reason);
+}
+
+/*********************************************************************
+ NAME: timeEngine
+ DESCRIPTION: Measures how long engine takes to calculate next generation
+	Input: type, now, next
+	Output: seconds, fastest of AUTO_TRIALS steps
+  Used global variables: -
+ REMARKS when using this function: overwrites next with the next generation
+*********************************************************************/
+double timeEngine(enum engine_type type, const struct lifeGrid *now, struct lifeGrid *next)
+{
+    double best = 0, start, time;
+    int trial;
+
+    for (trial = 0; trial < AUTO_TRIALS; trial++)
+    {
+        start = getTime();
+        stepPacked(type, now, next);
+        time = getTime() - start;
+        if (trial == 0 || time < best)
+            best = time;
+    }
+
+    return best;
+}
+
+/*********************************************************************
+ NAME: logEngineSwitch
+ DESCRIPTION: Writes engine switch and its reason to ENGINE_LOG
+	Input: from, to, reason
+	Output: -
+  Used global variables: autoselect
+ REMARKS when using this function: log is appended, stderr is not used because ncurses owns the screen
+*********************************************************************/
+void logEngineSwitch(enum engine_type from, enum engine_type to, const char *reason)
+{
+    FILE *file = fopen(ENGINE_LOG, "a");
+
+    if (autoselect.generations > 0)
+        autoselect.switches++;
+    if (file == NULL)
+        return;
+
+    if (autoselect.generations == 0)
+        fprintf(file, "gen %ld: start with %s (%s)\n", autoselect.generations, engine_names[to], reason);
+    else
+        fprintf(file, "gen %ld: %s -> %s (%s)\n", autoselect.generations, engine_names[from], engine_names[to], reason);
+    fclose(file);
+}
+
+/*********************************************************************
+ NAME: allocateActivity
+ DESCRIPTION: Allocates zeroed activity map counters for a board
+	Input: width, height
+	Output: TRUE, FALSE
+  Used global variables: activity
+ REMARKS when using this function: free with freeActivity()
+*********************************************************************/
+bool allocateActivity(int width, int height)
+{
+    size_t words;
+
+    // Counter rows are padded to whole words so accumulateRow() needs no bounds checks
+    activity.width = width;
+    activity.height = height;
+    activity.stride = (width + 63) / 64 * 64;
+    activity.tiles_x = activity.stride / ACTIVITY_TILE;
+    activity.tiles_y = (height + ACTIVITY_TILE - 1) / ACTIVITY_TILE;
+    activity.generations = 0;
+    activity.pending = 0;
+    words = (size_t)activity.stride / 64 * height;
+
+    activity.birth_low = (uint64_t*) calloc(words * ACTIVITY_LOW_PLANES, sizeof(uint64_t));
+    activity.alive_low = (uint64_t*) calloc(words * ACTIVITY_LOW_PLANES, sizeof(uint64_t));
+    activity.birth_planes = (uint64_t*) calloc(words * ACTIVITY_PLANES, sizeof(uint64_t));
+    activity.alive_planes = (uint64_t*) calloc(words * ACTIVITY_PLANES, sizeof(uint64_t));
+    activity.first = (uint64_t*) calloc(words, sizeof(uint64_t));
+    activity.last = (uint64_t*) calloc(words, sizeof(uint64_t));
+    activity.births = (uint32_t*) calloc((size_t)activity.stride * height, sizeof(uint32_t));
+    activity.alive = (uint32_t*) calloc((size_t)activity.stride * height, sizeof(uint32_t));
+    activity.tiles = (uint32_t*) calloc((size_t)activity.tiles_x * activity.tiles_y, sizeof(uint32_t));
+    if (activity.birth_low == NULL || activity.alive_low == NULL ||
+        activity.birth_planes == NULL || activity.alive_planes == NULL || activity.first == NULL || activity.last == NULL ||
+        activity.births == NULL || activity.alive == NULL || activity.tiles == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for activity map\n");
+        freeActivity();
+        return false;
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: freeActivity
+ DESCRIPTION: deallocates activity map
+	Input: -
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: deallocates memory created in allocateActivity()
+*********************************************************************/
+void freeActivity(void)
+{
+    free(activity.birth_low);
+    free(activity.alive_low);
+    free(activity.birth_planes);
+    free(activity.alive_planes);
+    free(activity.first);
+    free(activity.last);
+    free(activity.births);
+    free(activity.alive);
+    free(activity.tiles);
+    activity.birth_low = NULL;
+    activity.alive_low = NULL;
+    activity.birth_planes = NULL;
+    activity.alive_planes = NULL;
+    activity.first = NULL;
+    activity.last = NULL;
+    activity.births = NULL;
+    activity.alive = NULL;
+    activity.tiles = NULL;
+}
+
+/*********************************************************************
+ NAME: accumulateRow
+ DESCRIPTION: Adds one row of a generation step to the activity map
+	Input: y, now, next, words
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: now/next are packed rows of generation n and n + 1.
+                                    Births and alive masks are added to the low bit planes 64 cells at a time.
+*********************************************************************/
+void accumulateRow(int y, const uint64_t *now, const uint64_t *next, int words)
+{
+    size_t first = (size_t)y * (activity.stride / 64);
+    uint64_t *birth_low = activity.birth_low + first * ACTIVITY_LOW_PLANES;
+    uint64_t *alive_low = activity.alive_low + first * ACTIVITY_LOW_PLANES;
+    int w;
+
+    if (activity.generations == 0)
+        memcpy(activity.first + first, now, words * sizeof(uint64_t));
+    memcpy(activity.last + first, next, words * sizeof(uint64_t));
+
+    for (w = 0; w < words; w++)
+    {
+        addToPlanes(alive_low + w * ACTIVITY_LOW_PLANES, next[w]);
+        addToPlanes(birth_low + w * ACTIVITY_LOW_PLANES, next[w] & ~now[w]);
+    }
+}
+
+/*********************************************************************
+ NAME: addToPlanes
+ DESCRIPTION: Adds 1 to each of 64 bit sliced counters whose bit is set in mask
+	Input: planes, mask
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: planes[p] holds bit p of the counters, ACTIVITY_LOW_PLANES planes. Every plane
+                                    is updated without checking for the end of the carry, which is faster than
+                                    branching on boards that keep changing. Fold before the counters reach 2^ACTIVITY_LOW_PLANES.
+*********************************************************************/
+void addToPlanes(uint64_t *planes, uint64_t mask)
+{
+    uint64_t carry;
+
+    carry = planes[0] & mask;
+    planes[0] ^= mask;
+    mask = carry;
+    carry = planes[1] & mask;
+    planes[1] ^= mask;
+    mask = carry;
+    carry = planes[2] & mask;
+    planes[2] ^= mask;
+    mask = carry;
+    planes[3] ^= mask;
+}
+
+/*********************************************************************
+ NAME: foldPlanes
+ DESCRIPTION: Adds low bit planes to the other bit planes and clears them
+	Input: low, planes
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: 64 counters at a time with bitwise full adders
+*********************************************************************/
+void foldPlanes(uint64_t *low, uint64_t *planes)
+{
+    uint64_t carry = 0, sum;
+    int p;
+
+    for (p = 0; p < ACTIVITY_PLANES; p++)
+    {
+        uint64_t add = p < ACTIVITY_LOW_PLANES ? low[p] : 0;
+
+        sum = planes[p] ^ add ^ carry;
+        carry = (planes[p] & add) | (carry & (planes[p] ^ add));
+        planes[p] = sum;
+    }
+    for (p = 0; p < ACTIVITY_LOW_PLANES; p++)
+        low[p] = 0;
+}
+
+/*********************************************************************
+ NAME: foldActivity
+ DESCRIPTION: Adds low bit planes of the whole map to the other bit planes
+	Input: -
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: called every 2^ACTIVITY_LOW_PLANES - 1 generations and before flushing
+*********************************************************************/
+void foldActivity(void)
+{
+    size_t words = (size_t)activity.stride / 64 * activity.height, w;
+
+    for (w = 0; w < words; w++)
+    {
+        foldPlanes(activity.birth_low + w * ACTIVITY_LOW_PLANES, activity.birth_planes + w * ACTIVITY_PLANES);
+        foldPlanes(activity.alive_low + w * ACTIVITY_LOW_PLANES, activity.alive_planes + w * ACTIVITY_PLANES);
+    }
+}
+
+/*********************************************************************
+ NAME: flushActivity
+ DESCRIPTION: Adds bit planes to the 32-bit counters and clears them
+	Input: -
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: called every 255 generations and before the counters are read
+*********************************************************************/
+void flushActivity(void)
+{
+    size_t words = (size_t)activity.stride / 64 * activity.height, w;
+    int p, i;
+
+    foldActivity();
+
+    for (w = 0; w < words; w++)
+    {
+        uint64_t *birth_planes = activity.birth_planes + w * ACTIVITY_PLANES;
+        uint64_t *alive_planes = activity.alive_planes + w * ACTIVITY_PLANES;
+
+        for (p = 0; p < ACTIVITY_PLANES; p++)
+        {
+            if (birth_planes[p] != 0)
+                for (i = 0; i < 64; i++)
+                    activity.births[w * 64 + i] += (uint32_t)((birth_planes[p] >> i) & 1) << p;
+            if (alive_planes[p] != 0)
+                for (i = 0; i < 64; i++)
+                    activity.alive[w * 64 + i] += (uint32_t)((alive_planes[p] >> i) & 1) << p;
+            birth_planes[p] = 0;
+            alive_planes[p] = 0;
+        }
+    }
+
+    activity.pending = 0;
+}
+
+/*********************************************************************
+ NAME: countTiles
+ DESCRIPTION: Counts changed cells of each tile from births and the first and last state
+	Input: -
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: call flushActivity() first. Cell changes = births + deaths and a cell
+                                    dies once after each birth, plus once if it was alive at the start,
+                                    minus once if it is still alive, so changes = 2 x births + first - last.
+*********************************************************************/
+void countTiles(void)
+{
+    int x, y, words = activity.stride / 64;
+
+    memset(activity.tiles, 0, (size_t)activity.tiles_x * activity.tiles_y * sizeof(uint32_t));
+
+    for (y = 0; y < activity.height; y++)
+    {
+        uint32_t *tiles = activity.tiles + (size_t)(y / ACTIVITY_TILE) * activity.tiles_x;
+        const uint32_t *births = activity.births + (size_t)y * activity.stride;
+        const uint64_t *first = activity.first + (size_t)y * words, *last = activity.last + (size_t)y * words;
+
+        for (x = 0; x < activity.width; x++)
+            tiles[x / ACTIVITY_TILE] += 2 * births[x] + ((first[x / 64] >> (x % 64)) & 1) - ((last[x / 64] >> (x % 64)) & 1);
+    }
+}
+
+/*********************************************************************
+ NAME: accumulateActivity
+ DESCRIPTION: Adds a step of a packed engine to the activity map
+	Input: now, next
+	Output: -
+  Used global variables: activity
+ REMARKS when using this function: allocateActivity() should be called beforehand
+*********************************************************************/
+void accumulateActivity(const struct lifeGrid *now, const struct lifeGrid *next)
+{
+    int y;
+
+    for (y = 0; y < now->height; y++)
+        accumulateRow(y, GRID_ROW(now, y), GRID_ROW(next, y), now->words);
+
+    activity.generations++;
+    if (++activity.pending == (1 << ACTIVITY_PLANES) - 1)
+        flushActivity();
+    else if (activity.pending % ((1 << ACTIVITY_LOW_PLANES) - 1) == 0)
+        foldActivity();
+}
+
+/*********************************************************************
+ NAME: accumulateBoard
+ DESCRIPTION: Adds a step of the reference engine to the activity map
+	Input: -
+	Output: -
+  Used global variables: activity, xy_size, **board
+ REMARKS when using this function: cell's future should be calculated beforehand
+*********************************************************************/
+void accumulateBoard(void)
+{
+    // Board is at most 100 cells wide = 2 words
+    uint64_t now[2], next[2];
+    int x, y, words = (xy_size[0] + 63) / 64;
+
+    for (y = 0; y < xy_size[1]; y++)
+    {
+        now[0] = now[1] = next[0] = next[1] = 0;
+        for (x = 0; x < xy_size[0]; x++)
+        {
+            now[x / 64] |= (uint64_t)board[x][y].current << (x % 64);
+            next[x / 64] |= (uint64_t)board[x][y].future << (x % 64);
+        }
+        accumulateRow(y, now, next, words);
+    }
+
+    activity.generations++;
+    if (++activity.pending == (1 << ACTIVITY_PLANES) - 1)
+        flushActivity();
+    else if (activity.pending % ((1 << ACTIVITY_LOW_PLANES) - 1) == 0)
+        foldActivity();
+}
+
+/*********************************************************************
+ NAME: writeActivityFile
+ DESCRIPTION: Writes counters to a PGM image or CSV file
+	Input: filename, counts, width, height, stride
+	Output: TRUE, FALSE
+  Used global variables: activity_export
+ REMARKS when using this function: PGM is scaled so the largest counter is white, the largest
+                                    counter is written as a comment. CSV has one line per row.
+*********************************************************************/
+bool writeActivityFile(const char *filename, const uint32_t *counts, int width, int height, int stride)
+{
+    FILE *file;
+    uint32_t max = 0;
+    int x, y;
+
+    file = fopen(filename, activity_export == ACTIVITY_PGM ? "wb" : "w");
+    if (file == NULL)
+    {
+        printf("%sError opening file:%s %s\n", RED, RESET_COLOR, filename);
+        return false;
+    }
+
+    if (activity_export == ACTIVITY_PGM)
+    {
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+                if (counts[(size_t)y * stride + x] > max)
+                    max = counts[(size_t)y * stride + x];
+
+        fprintf(file, "P5\n# max %u after %ld generations\n%d %d\n255\n", max, activity.generations, width, height);
+        for (y = 0; y < height; y++)
+            for (x = 0; x < width; x++)
+                fputc(max ? (int)((uint64_t)counts[(size_t)y * stride + x] * 255 / max) : 0, file);
+    }
+    else
+    {
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+                fprintf(file, x ? ",%u" : "%u", counts[(size_t)y * stride + x]);
+            fprintf(file, "\n");
+        }
+    }
+
+    fclose(file);
+    printf("Activity written to %s\n", filename);
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: exportActivity
+ DESCRIPTION: Writes birth counts, generations alive and tile activity of the run
+	Input: -
+	Output: TRUE, FALSE
+  Used global variables: activity, activity_export
+ REMARKS when using this function: files are ACTIVITY_PREFIX_births, _alive and _tiles with .pgm or .csv extension
+*********************************************************************/
+bool exportActivity(void)
+{
+    const char *ext = activity_export == ACTIVITY_PGM ? "pgm" : "csv";
+    char filename[100];
+    bool ok = true;
+
+    flushActivity();
+    countTiles();
+
+    sprintf(filename, "%s_births.%s", ACTIVITY_PREFIX, ext);
+    ok &= writeActivityFile(filename, activity.births, activity.width, activity.height, activity.stride);
+    sprintf(filename, "%s_alive.%s", ACTIVITY_PREFIX, ext);
+    ok &= writeActivityFile(filename, activity.alive, activity.width, activity.height, activity.stride);
+    sprintf(filename, "%s_tiles.%s", ACTIVITY_PREFIX, ext);
+    ok &= writeActivityFile(filename, activity.tiles, (activity.width + ACTIVITY_TILE - 1) / ACTIVITY_TILE,
+                            activity.tiles_y, activity.tiles_x);
+
+    return ok;
+}
+
+/*********************************************************************
+ NAME: startServer
+ DESCRIPTION: Opens frame server socket for viewers
+	Input: -
+	Output: TRUE, FALSE
+  Used global variables: server, server_address
+ REMARKS when using this function: server_address = port number (TCP, localhost only) or path of a Unix socket.
+                                    Socket is non-blocking, viewers are accepted while the game runs.
+*********************************************************************/
+bool startServer(void)
+{
+    server.listen_fd = -1;
+    server.client_count = 0;
+    server.generation = 0;
+    server.last_flush = 0;
+    server.sent_frames = 0;
+    server.keyframes = 0;
+    server.dropped = 0;
+
+    #ifdef HAVE_SYS_SOCKET_H
+    int fd, port, one = 1;
+    struct stat info;
+
+    if (isNumber(server_address))
+    {
+        struct sockaddr_in address;
+
+        port = atoi(server_address);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+        {
+            fprintf(stderr, "Error: Frame server can not use port %d: %s\n", port, strerror(errno));
+            if (fd >= 0)
+                close(fd);
+            return false;
+        }
+    }
+    else
+    {
+        struct sockaddr_un address;
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, server_address, sizeof(address.sun_path) - 1);
+        // Socket file left by an earlier run is replaced, any other file is left alone
+        if (lstat(server_address, &info) == 0)
+        {
+            if (S_ISSOCK(info.st_mode) == 0)
+            {
+                fprintf(stderr, "Error: Frame server will not replace %s, it is not a socket\n", server_address);
+                if (fd >= 0)
+                    close(fd);
+                return false;
+            }
+            unlink(server_address);
+        }
+        if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+        {
+            fprintf(stderr, "Error: Frame server can not use %s: %s\n", server_address, strerror(errno));
+            if (fd >= 0)
+                close(fd);
+            return false;
+        }
+    }
+
+    if (listen(fd, SERVER_BACKLOG) != 0)
+    {
+        fprintf(stderr, "Error: Frame server can not listen: %s\n", strerror(errno));
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    server.listen_fd = fd;
+
+    return true;
+    #else
+    fprintf(stderr, "Error: Frame server needs sockets (HAVE_SYS_SOCKET_H)\n");
+    return false;
+    #endif
+}
+
+/*********************************************************************
+ NAME: stopServer
+ DESCRIPTION: Disconnects viewers and closes frame server
+	Input: -
+	Output: -
+  Used global variables: server, server_address
+ REMARKS when using this function: Viewers get what is still in their buffers and the last board, but they are
+                                    waited for at most SERVER_CLOSE_SECONDS. Board should not have moved since
+                                    the last publishFrame().
+*********************************************************************/
+void stopServer(void)
+{
+    #ifdef HAVE_SYS_SOCKET_H
+    struct pollfd *poll_fds;
+    struct stat info;
+    double end = getTime() + SERVER_CLOSE_SECONDS;
+    int i, waiting;
+
+    if (server.listen_fd < 0)
+        return;
+
+    // No viewers join while closing, so room for the ones connected now is enough
+    poll_fds = (struct pollfd*) malloc((server.client_count + 1) * sizeof(struct pollfd));
+    do
+    {
+        sendKeyframes(false);
+        flushViewers(getTime());
+
+        // Wait until a socket takes more
+        for (i = 0, waiting = 0; i < server.client_count; i++)
+        {
+            if (server.clients[i].out.sent < server.clients[i].out.length || server.clients[i].needs_keyframe)
+            {
+                if (poll_fds != NULL)
+                {
+                    poll_fds[waiting].fd = server.clients[i].fd;
+                    poll_fds[waiting].events = POLLOUT;
+                }
+                waiting++;
+            }
+        }
+        if (waiting > 0 && poll_fds == NULL)
+            break;
+        if (waiting > 0)
+            poll(poll_fds, waiting, 1000 / REDRAW_HZ);
+    } while (waiting > 0 && getTime() < end);
+    free(poll_fds);
+
+    // Viewers that did not take everything in time
+    server.dropped += waiting;
+    while (server.client_count > 0)
+        dropViewer(0);
+    close(server.listen_fd);
+    server.listen_fd = -1;
+    if (isNumber(server_address) == false && lstat(server_address, &info) == 0 && S_ISSOCK(info.st_mode))
+        unlink(server_address);
+    #endif
+
+    free(server.clients);
+    server.clients = NULL;
+    server.client_capacity = 0;
+    free(server.frame.data);
+    free(server.keyframe.data);
+    free(server.births.data);
+    free(server.deaths.data);
+    memset(&server.frame, 0, sizeof(server.frame));
+    memset(&server.keyframe, 0, sizeof(server.keyframe));
+    memset(&server.births, 0, sizeof(server.births));
+    memset(&server.deaths, 0, sizeof(server.deaths));
+}
+
+/*********************************************************************
+ NAME: publishFrame
+ DESCRIPTION: Sends births and deaths of the generation just calculated to viewers
+	Input: -
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: call after the engine calculated the future, before the board moves to it.
+                                    A viewer whose buffer is full gets no more deltas. When its buffer is empty
+                                    again it gets one keyframe instead of everything it missed. A viewer that
+                                    stays behind SERVER_DROP_SECONDS is disconnected. Sockets are only touched
+                                    every SERVER_FLUSH_SECONDS, so viewers never slow the game down.
+*********************************************************************/
+void publishFrame(void)
+{
+    int i;
+    double now = getTime();
+    bool flush = now - server.last_flush >= SERVER_FLUSH_SECONDS;
+    bool delta_ready = false;
+
+    server.generation++;
+
+    if (flush)
+        acceptViewers();
+
+    for (i = 0; i < server.client_count; i++)
+    {
+        struct viewerClient *client = &server.clients[i];
+
+        if (client->needs_keyframe == false)
+        {
+            if (delta_ready == false)
+            {
+                encodeDelta();
+                delta_ready = true;
+            }
+
+            // Buffer full: stop sending deltas, keyframe replaces them later
+            if (client->out.length - client->out.sent + server.frame.length > SERVER_CLIENT_BUFFER)
+            {
+                client->needs_keyframe = true;
+                client->behind_since = now;
+            }
+            else
+            {
+                appendBytes(&client->out, server.frame.data, server.frame.length);
+                server.sent_frames++;
+            }
+        }
+    }
+    sendKeyframes(true);
+
+    if (flush)
+    {
+        flushViewers(now);
+        server.last_flush = now;
+    }
+}
+
+/*********************************************************************
+ NAME: serveViewers
+ DESCRIPTION: Accepts new viewers and sends waiting frames while the game is not stepping
+	Input: -
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: called while paused or waiting, so viewers do not wait for the next generation.
+                                    Does nothing if frame server is not running.
+*********************************************************************/
+void serveViewers(void)
+{
+    if (server.listen_fd < 0)
+        return;
+
+    acceptViewers();
+    sendKeyframes(false);
+    flushViewers(getTime());
+    server.last_flush = getTime();
+}
+
+/*********************************************************************
+ NAME: sendKeyframes
+ DESCRIPTION: Gives a keyframe to every viewer that waits for one and has sent everything else
+	Input: future
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: future = TRUE: keyframe of the generation just calculated (see publishFrame()),
+                                    FALSE: keyframe of the board as it is now
+*********************************************************************/
+void sendKeyframes(bool future)
+{
+    bool keyframe_ready = false;
+    int i;
+
+    for (i = 0; i < server.client_count; i++)
+    {
+        struct viewerClient *client = &server.clients[i];
+
+        if (client->needs_keyframe == false || client->out.sent != client->out.length)
+            continue;
+        if (keyframe_ready == false)
+        {
+            encodeKeyframe(future);
+            keyframe_ready = true;
+        }
+        client->out.length = client->out.sent = 0;
+        appendBytes(&client->out, server.keyframe.data, server.keyframe.length);
+        client->needs_keyframe = false;
+        server.keyframes++;
+    }
+}
+
+/*********************************************************************
+ NAME: acceptViewers
+ DESCRIPTION: Accepts viewers waiting to connect
+	Input: -
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: new viewer gets a keyframe first. server.clients grows as needed,
+                                    a viewer there is no memory for is disconnected at once.
+*********************************************************************/
+void acceptViewers(void)
+{
+    #ifdef HAVE_SYS_SOCKET_H
+    struct viewerClient *clients, *client;
+    int fd, capacity;
+
+    while ((fd = accept(server.listen_fd, NULL, NULL)) >= 0)
+    {
+        if (server.client_count == server.client_capacity)
+        {
+            capacity = server.client_capacity > 0 ? server.client_capacity * 2 : 8;
+            clients = (struct viewerClient*) realloc(server.clients, capacity * sizeof(struct viewerClient));
+            if (clients == NULL)
+            {
+                close(fd);
+                server.dropped++;
+                continue;
+            }
+            server.clients = clients;
+            server.client_capacity = capacity;
+        }
+
+        client = &server.clients[server.client_count++];
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        memset(client, 0, sizeof(*client));
+        client->fd = fd;
+        client->needs_keyframe = true;
+        client->behind_since = getTime();
+    }
+    #endif
+}
+
+/*********************************************************************
+ NAME: flushViewers
+ DESCRIPTION: Sends as much of each viewer's buffer as its socket takes without waiting
+	Input: now
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: viewers that closed or stayed behind too long are dropped
+*********************************************************************/
+void flushViewers(double now)
+{
+    #ifdef HAVE_SYS_SOCKET_H
+    int i;
+
+    for (i = 0; i < server.client_count; i++)
+    {
+        struct viewerClient *client = &server.clients[i];
+        ssize_t sent = 0;
+
+        if (client->out.sent < client->out.length)
+            sent = send(client->fd, client->out.data + client->out.sent, client->out.length - client->out.sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if ((sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) ||
+            (client->needs_keyframe && now - client->behind_since > SERVER_DROP_SECONDS))
+        {
+            dropViewer(i);
+            server.dropped++;
+            i--;
+            continue;
+        }
+        if (sent > 0)
+            client->out.sent += sent;
+
+        // Keep unsent bytes at the start of the buffer
+        if (client->out.sent == client->out.length)
+            client->out.sent = client->out.length = 0;
+        else if (client->out.sent > client->out.capacity / 2)
+        {
+            memmove(client->out.data, client->out.data + client->out.sent, client->out.length - client->out.sent);
+            client->out.length -= client->out.sent;
+            client->out.sent = 0;
+        }
+    }
+    #endif
+}
+
+/*********************************************************************
+ NAME: dropViewer
+ DESCRIPTION: Disconnects viewer
+	Input: index
+	Output: -
+  Used global variables: server
+ REMARKS when using this function: last viewer is moved to index
+*********************************************************************/
+void dropViewer(int index)
+{
+    #ifdef HAVE_SYS_SOCKET_H
+    close(server.clients[index].fd);
+    #endif
+    free(server.clients[index].out.data);
+    server.clients[index] = server.clients[--server.client_count];
+}
+
+/*********************************************************************
+ NAME: frameRows
+ DESCRIPTION: Copies row y of the board now and in the future as packed words
+	Input: y, now, next
+	Output: -
+  Used global variables: engine, life, life_now, xy_size, **board
+ REMARKS when using this function: now/next must have room for 2 words (board is at most 100 wide).
+                                    Engine should have calculated the future, board not moved to it yet.
+                                    Between generations only now is valid.
+*********************************************************************/
+void frameRows(int y, uint64_t *now, uint64_t *next)
+{
+    int x, w, words = (xy_size[0] + 63) / 64;
+
+    if (engine == ENGINE_REFERENCE)
+    {
+        now[0] = now[1] = next[0] = next[1] = 0;
+        for (x = 0; x < xy_size[0]; x++)
+        {
+            now[x / 64] |= (uint64_t)board[x][y].current << (x % 64);
+            next[x / 64] |= (uint64_t)board[x][y].future << (x % 64);
+        }
+        return;
+    }
+
+    for (w = 0; w < words; w++)
+    {
+        now[w] = GRID_ROW(&life[life_now], y)[w];
+        next[w] = GRID_ROW(&life[!life_now], y)[w];
+    }
+}
+
+/*********************************************************************
+ NAME: encodeDelta
+ DESCRIPTION: Builds delta frame of the generation in server.frame
+	Input: -
+	Output: -
+  Used global variables: server, xy_size
+ REMARKS when using this function: frame = 'D', generation, width, height, payload length, payload.
+                                    Payload = birth count, births, death count, deaths. Cells are
+                                    gaps between row-major cell numbers as varints.
+*********************************************************************/
+void encodeDelta(void)
+{
+    uint64_t now[2], next[2], bits;
+    long births = 0, deaths = 0, last_birth = -1, last_death = -1, cell;
+    int y, w, words = (xy_size[0] + 63) / 64;
+
+    server.births.length = 0;
+    server.deaths.length = 0;
+
+    for (y = 0; y < xy_size[1]; y++)
+    {
+        frameRows(y, now, next);
+        for (w = 0; w < words; w++)
+        {
+            for (bits = next[w] & ~now[w]; bits != 0; bits &= bits - 1)
+            {
+                cell = (long)y * xy_size[0] + w * 64 + lowestBit(bits);
+                appendVarint(&server.births, cell - last_birth - 1);
+                last_birth = cell;
+                births++;
+            }
+            for (bits = now[w] & ~next[w]; bits != 0; bits &= bits - 1)
+            {
+                cell = (long)y * xy_size[0] + w * 64 + lowestBit(bits);
+                appendVarint(&server.deaths, cell - last_death - 1);
+                last_death = cell;
+                deaths++;
+            }
+        }
+    }
+
+    server.frame.length = 0;
+    appendFrameHeader(&server.frame, 'D');
+    appendVarint(&server.frame, births);
+    appendBytes(&server.frame, server.births.data, server.births.length);
+    appendVarint(&server.frame, deaths);
+    appendBytes(&server.frame, server.deaths.data, server.deaths.length);
+    finishFrame(&server.frame);
+}
+
+/*********************************************************************
+ NAME: encodeKeyframe
+ DESCRIPTION: Builds keyframe of the board in server.keyframe
+	Input: future
+	Output: -
+  Used global variables: server, xy_size
+ REMARKS when using this function: future = TRUE: board the engine just calculated, FALSE: board as it is now.
+                                    payload = lengths of dead and alive runs in turn as varints,
+                                    starting with dead, cells in row-major order
+*********************************************************************/
+void encodeKeyframe(bool future)
+{
+    uint64_t now[2], next[2];
+    long run = 0;
+    int x, y, alive = 0, cell;
+
+    server.keyframe.length = 0;
+    appendFrameHeader(&server.keyframe, 'K');
+
+    for (y = 0; y < xy_size[1]; y++)
+    {
+        frameRows(y, now, next);
+        for (x = 0; x < xy_size[0]; x++)
+        {
+            cell = ((future ? next : now)[x / 64] >> (x % 64)) & 1;
+            if (cell != alive)
+            {
+                appendVarint(&server.keyframe, run);
+                run = 0;
+                alive = cell;
+            }
+            run++;
+        }
+    }
+    appendVarint(&server.keyframe, run);
+    finishFrame(&server.keyframe);
+}
+
+/*********************************************************************
+ NAME: appendFrameHeader
+ DESCRIPTION: Starts a frame: type, generation, width, height and room for payload length
+	Input: buffer, type
+	Output: -
+  Used global variables: server, xy_size
+ REMARKS when using this function: numbers are little endian, finishFrame() fills in payload length
+*********************************************************************/
+void appendFrameHeader(struct byteBuffer *buffer, char type)
+{
+    unsigned char header[FRAME_HEADER_SIZE];
+    int i;
+
+    header[0] = (unsigned char)type;
+    for (i = 0; i < 8; i++)
+        header[1 + i] = (unsigned char)((uint64_t)server.generation >> (8 * i));
+    for (i = 0; i < 4; i++)
+    {
+        header[9 + i] = (unsigned char)((uint32_t)xy_size[0] >> (8 * i));
+        header[13 + i] = (unsigned char)((uint32_t)xy_size[1] >> (8 * i));
+        header[17 + i] = 0;
+    }
+    appendBytes(buffer, header, FRAME_HEADER_SIZE);
+}
+
+/*********************************************************************
+ NAME: finishFrame
+ DESCRIPTION: Writes payload length to frame header
+	Input: buffer
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: buffer should hold exactly one frame
+*********************************************************************/
+void finishFrame(struct byteBuffer *buffer)
+{
+    uint32_t length = (uint32_t)(buffer->length - FRAME_HEADER_SIZE);
+    int i;
+
+    for (i = 0; i < 4; i++)
+        buffer->data[17 + i] = (unsigned char)(length >> (8 * i));
+}
+
+/*********************************************************************
+ NAME: appendBytes
+ DESCRIPTION: Adds bytes to the end of buffer, buffer grows when needed
+	Input: buffer, bytes, count
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: out of memory leaves buffer unchanged
+*********************************************************************/
+void appendBytes(struct byteBuffer *buffer, const void *bytes, size_t count)
+{
+    if (buffer->length + count > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        unsigned char *data;
+
+        while (capacity < buffer->length + count)
+            capacity *= 2;
+        data = (unsigned char*) realloc(buffer->data, capacity);
+        if (data == NULL)
+            return;
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    if (count > 0)
+        memcpy(buffer->data + buffer->length, bytes, count);
+    buffer->length += count;
+}
+
+/*********************************************************************
+ NAME: appendVarint
+ DESCRIPTION: Adds number to buffer, 7 bits per byte, high bit = more bytes follow
+	Input: buffer, value
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: small numbers take one byte
+*********************************************************************/
+void appendVarint(struct byteBuffer *buffer, uint64_t value)
+{
+    unsigned char bytes[10];
+    int count = 0;
+
+    do
+    {
+        bytes[count] = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            bytes[count] |= 0x80;
+        count++;
+    } while (value != 0);
+
+    appendBytes(buffer, bytes, count);
+}
+
+/*********************************************************************
+ NAME: lowestBit
+ DESCRIPTION: Returns position of lowest set bit
+	Input: word
+	Output: 0 ... 63
+  Used global variables: -
+ REMARKS when using this function: word must not be 0
+*********************************************************************/
+int lowestBit(uint64_t word)
+{
+    #if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+    #else
+    int bit = 0;
+
+    while (((word >> bit) & 1) == 0)
+        bit++;
+    return bit;
+    #endif
+}
+
+/*********************************************************************
+ NAME: isNumber
+ DESCRIPTION: Checks if string has only digits
+	Input: string
+	Output: TRUE, FALSE
+  Used global variables: -
+ REMARKS when using this function: empty string is not a number
+*********************************************************************/
+bool isNumber(const char *string)
+{
+    if (*string == '\0')
+        return false;
+
+    for (; *string != '\0'; string++)
+        if (isdigit((unsigned char)*string) == 0)
+            return false;
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: printState
+ DESCRIPTION: displays/prints game state to user, and updates future state.
+	Input: -
+	Output: -
+  Used global variables: xy_size
+ REMARKS when using this function: Cell's future should be calculated beforehand.
+*********************************************************************/
+void printState()
+{
+    #ifdef HAVE_NCURSES_H
+    clear();
+    printw("\n");
+    #else
+    printf("\n");
+    #endif
+
+    int x, y;
+
+    for (y = 0; y < xy_size[1]; y++)
+    {
+        for (x = 0; x < xy_size[0]; x++)
+        {
+            if (board[x][y].current == 1)
+            {
+                printCellState(true, board[x][y].color);
+            }
+            else
+            {
+                printCellState(false, board[x][y].color);
+            }
+            
+            // Above we print current state, and update to the next state.
+            board[x][y].current = board[x][y].future;
+            // reset color
+            board[x][y].color = 'd';
+        }
+        #ifdef HAVE_NCURSES_H
+        printw("\n");
+        #else
+        printf("\n");
+        #endif
+    }
+
+    #ifdef HAVE_NCURSES_H
+    refresh();
+    #endif
+
+}
+
+/*********************************************************************
+ NAME: printCellState
+ DESCRIPTION: Prints 'O' or '.' with the correct color 
+	Input: alive_or_dead, color
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: input cell state and color, function prints character
+*********************************************************************/
+void printCellState(bool alive_or_dead, char color) 
+{
+    #ifdef HAVE_NCURSES_H
+    start_color();
+
+    init_pair(1, COLOR_RED, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    init_pair(3, COLOR_YELLOW, COLOR_BLACK);
+
+    switch(color)
+    {
+        case 'r':
+            attron(COLOR_PAIR(1));
+            break;
+        case 'g':
+            attron(COLOR_PAIR(2));
+            break;
+        default:
+            attron(COLOR_PAIR(1));
+            break;
+    }
+
+    printw("%c", alive_or_dead ? alive_char : dead_char);
+
+    #else
+    switch(color)
+    {
+        case 'r':
+            printf("%s", RED);
+            break;
+        case 'g':
+            printf("%s", GREEN);
+            break;
+        default:
+            printf("%s", RESET_COLOR);
+            break;
+    }
+
+    // syntax: variable ? 'true' : 'false' || same as: if (variable == 1) .. else ..
+    printf("%c", alive_or_dead ? alive_char : dead_char);
+
+    printf("%s", RESET_COLOR);
+    #endif
+}
+
+/*********************************************************************
+ NAME: delay
+ DESCRIPTION: Adds delay with clock_t in the time.h library
+	Input: milliseconds
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: -
+*********************************************************************/
+void delay(int milliseconds)
+{
+    // Storing start time
+    clock_t start_time = clock();
+ 
+    // looping till required time is not achieved
+    while (clock() < start_time + milliseconds * (CLOCKS_PER_SEC / 1000));
+}
+
+/*********************************************************************
+ NAME: getTime
+ DESCRIPTION: Returns wall clock time in seconds
+	Input: -
+	Output: seconds
+  Used global variables: -
+ REMARKS when using this function: only differences between two calls are meaningful
+*********************************************************************/
+double getTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/*********************************************************************
+ NAME: printInstructions
+ DESCRIPTION: prints instructions to user
+	Input: string
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: string is passed to print corresponding instructions ("state")
+*********************************************************************/
+void printInstructions(char state[])
+{
+    if (state == "welcome")
+    {
+        printf("What would you like to do?\n");
+        printf("%s A) Play game\n", MAGENTA);
+        printf(" B) Settings\n");
+        printf(" C) Show highscore\n");
+        printf(" D) Benchmark engines\n");
+        printf(" E) Watch remote game\n");
+        printf(" H) Show this menu\n");
+        printf(" X) Exit program\n");
+    }
+    else if (state == "gameoflife")
+    {
+        printf("\nThis is the GAME OF LIFE.\n");
+        printf("The rules are simple:\n");
+        printf("%s\t- Each cell with one or no neighbours' dies, as if by loneliness.\n", YELLOW);
+        printf("\t- Each cell with four or more neighbours dies, as if by overpopulation.\n");
+        printf("\t- Each cell with two or three neighbours survives.\n");
+        printf("\t- Each cell with three neighbours becomes populated. (unpopulated spaces)%s\n", RESET_COLOR);
+        printf("Keys while running: [space] pause, [s] single step, [+/-] speed, [r] draw mode, [q] quit\n");
+        printf("Lets start?\n\n");
+    }
+    else if (state == "settings")
+    {
+        printf("\nSettings\n");
+        printf("%sA) Help!!\n", MAGENTA);
+        printf("B) Read gamestate from file\n");
+        printf("C) Paste gamestate as string\n");
+        printf("D) Randomize gamestate\n");
+        printf("E) Select engine\n");
+        printf("F) Select draw mode\n");
+        printf("G) Activity map\n");
+        printf("H) Threads and memory placement\n");
+        printf("I) Frame server\n");
+        printf("X) Back%s\n\n", RESET_COLOR);
+    }
+    else if (state == "benchmark")
+    {
+        printf("%sA) Engines on 100x100 board\n", MAGENTA);
+        printf("B) Temporal blocking on %dx%d board\n", TEMPORAL_BENCH_SIZE, TEMPORAL_BENCH_SIZE);
+        printf("C) Large board run with threads (see settings H)\n");
+        printf("D) Fixed size kernels against generic dense engine%s\n", RESET_COLOR);
+    }
+    else if (state == "placement")
+    {
+        printf("Memory placement:\n");
+        printf("%sA) First touch (each thread's rows on its own NUMA node)\n", MAGENTA);
+        printf("B) Master thread (whole board where main thread runs)%s\n", RESET_COLOR);
+    }
+    else if (state == "pinning")
+    {
+        printf("Thread pinning:\n");
+        printf("%sA) None\n", MAGENTA);
+        printf("B) Compact (thread i on cpu i)\n");
+        printf("C) Scatter (threads spread over NUMA nodes)%s\n", RESET_COLOR);
+    }
+    else if (state == "engines")
+    {
+        printf("%sA) Reference (calculateFuture)\n", MAGENTA);
+        printf("B) Lookup table (2x2 cells per lookup)\n");
+        printf("C) Dense (64 cells per operation)\n");
+        printf("D) Sparse (only where cells change)\n");
+        printf("E) Automatic (switches between B, C and D)%s\n", RESET_COLOR);
+    }
+    else if (state == "render")
+    {
+        printf("%sA) Draw every generation\n", MAGENTA);
+        printf("B) Draw every Nth generation\n");
+        printf("C) As fast as possible, draw %d times per second\n", REDRAW_HZ);
+        printf("D) Headless, do not draw (watch with frame server)%s\n", RESET_COLOR);
+    }
+    else if (state == "activity")
+    {
+        printf("%sA) Off\n", MAGENTA);
+        printf("B) Save as PGM images\n");
+        printf("C) Save as CSV%s\n", RESET_COLOR);
+    }
+    else if (state == "settingshelp")
+    {
+        printf("%sB) Read gamestate from file\n", MAGENTA);
+        printf("\t%s- use: file longest column = board column, file rows = board rows\n", YELLOW);
+        printf("\t- cell state: The most occured character = dead, second most occured = alive\n");
+        printf("\t\t- NOTE: default to 'o' = alive, '.' = dead, if they are the most/2most occured\n\n%s", MAGENTA);
+        printf("C) Paste gamestate as string\n");
+        printf("\t%s- use: paste string with ctrl+v or shift+insert\n", YELLOW);
+        printf("\t- Format: (note: end with 'e')\n");
+        printf("\t  ....o\n");
+        printf("\t  .oo..\n");
+        printf("\t  .....%s\n\n", MAGENTA);
+        printf("D) Randomize gamestate\n");
+        printf("\t%s- This will generate a random size. Delay time default is 500ms / 0.5s\n\n", YELLOW);
+        printf("%sE) Select engine\n", MAGENTA);
+        printf("\t%s- Reference checks every cell's neighbours one by one\n", YELLOW);
+        printf("\t- Lookup table calculates 2x2 cells at a time from a precomputed table, same results\n");
+        printf("\t- Dense calculates 64 cells at a time, sparse skips parts of the board where nothing changes\n");
+        printf("\t- Automatic checks the board every %d generations and picks the fastest, switches go to %s\n\n",
+               AUTO_SAMPLE_GENERATIONS, ENGINE_LOG);
+        printf("%sF) Select draw mode\n", MAGENTA);
+        printf("\t%s- Every Nth generation / %d times per second: generations in between are calculated but not drawn\n\n", YELLOW, REDRAW_HZ);
+        printf("%sG) Activity map\n", MAGENTA);
+        printf("\t%s- Counts births and generations alive of each cell, and changes of each %dx%d tile\n", YELLOW, ACTIVITY_TILE, ACTIVITY_TILE);
+        printf("\t- Saved to %s_births, %s_alive and %s_tiles when game ends\n\n", ACTIVITY_PREFIX, ACTIVITY_PREFIX, ACTIVITY_PREFIX);
+        printf("%sH) Threads and memory placement\n", MAGENTA);
+        printf("\t%s- Used by large board runs (benchmark C). Each thread calculates a stripe of rows\n", YELLOW);
+        printf("\t- First touch puts each stripe in the memory of the thread's own NUMA node\n");
+        printf("\t- Generations per sweep above 1 steps each stripe that many generations at a time (temporal blocking)\n\n");
+        printf("%sI) Frame server\n", MAGENTA);
+        printf("\t%s- Sends births and deaths of every generation to viewers (main menu E) while the game runs\n", YELLOW);
+        printf("\t- Slow viewers skip generations, the game never waits for them\n\n");
+        printf("%sX) Go back to previous menu%s\n", MAGENTA, RESET_COLOR);
+        
+    }
+}
+
+/*********************************************************************
+ NAME: allocateMemory
+ DESCRIPTION: Dynamically allocates memory for global: struct cell and xy_size
+	Input: 
+	Output: -
+  Used global variables: xy_size, **board, alive_cells
+ REMARKS when using this function: takes size of the board as arguments, and uses malloc to initialize/set each value
+*********************************************************************/
+bool allocateMemory()
+{
+    // Check that x and y values fall between a certain range.
+    if (xy_size[0] < 1 || xy_size[1] < 1 || xy_size[0] > 100 || xy_size[1] > 100)
+        return false;
+
+    int i, j;
+
+    // Allocate memory for the board columns. Size * struct cell size
+    board = (struct cell**) malloc(xy_size[0] * sizeof(struct cell*));
+
+    // Handle error
+    if (board == NULL) 
+    {
+        // stderr could be replaced by pointer to file pointer, to write to a file.
+        // It uses a different stream (not input stream). However since its set as "stderr" it writes to console
+        fprintf(stderr, "Error: Failed to allocate memory for board\n");
+        return false;
+    }
+
+    // Iterate through rows
+    for (int i = 0; i < xy_size[0]; i++) 
+    {
+        // allocate memory
+        board[i] = (struct cell*) malloc(xy_size[1] * sizeof(struct cell));
+        // Handle error
+        if (board[i] == NULL) 
+        {
+            fprintf(stderr, "Error: Failed to allocate memory for board[%d]\n", i); 
+            return false;
+        }
+    }
+
+    // Initialize the board
+    for (int i = 0; i < xy_size[1]; i++) 
+    {
+        for (int j = 0; j < xy_size[0]; j++) 
+        {
+            if (alive_cells[j][i] == 1)
+                board[j][i].current = 1;
+            else
+                board[j][i].current = 0;
+
+            // Allocate for each other parameter too.
+            board[j][i].future = 0;
+            board[j][i].color = 'd';
+        }
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: deAllocateMemory
+ DESCRIPTION: deallocates memory
+	Input: -
+	Output: -
+  Used global variables: xy_size, **board
+ REMARKS when using this function: deallocates memory created in allocateMemory()
+*********************************************************************/
+void deAllocateMemory(void)
+{
+    int i;
+
+    /* Free memory for board */
+    for (i = 0; i < xy_size[0]; i++) 
+    {
+        free(board[i]);
+    }
+    free(board);
+
+}
+
+/*********************************************************************
+ NAME: clear_input_buffer
+ DESCRIPTION: clears the input buffer 
+	Input:  -
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: only clears until \n or EOF ("12 2 \n 23" -> " 23" will be left in input buffer)
+*********************************************************************/
+void clear_input_buffer(void)
+{
+  int c;
+  do {
+    c = getchar();
+  } while (c != '\n' && c != EOF);
+}
+
+/*********************************************************************
+ NAME: modifySettings()
+ DESCRIPTION: 
+	Input: 
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: -
+*********************************************************************/
+void modifySettings(void)
+{
+    printInstructions("settings");
+    char command;
+    do 
+    {
+        command = ask_command();
+        
+        switch (command) 
+        {
+            case 'A': // HELP
+                printInstructions("settingshelp");
+                break;
+            case 'B': // READ FILE
+                if (readGameFromFile() == 1)
+                    printf("%sFile read and game initialized *thumbs up*", GREEN);
+                else
+                    printf("%sSomething went wrong :(%s", RED, RESET_COLOR);
+                break;
+            case 'C': // MANUAL
+
+                break;
+            case 'D': // RANDOMIZE
+
+                break;
+            case 'E': // ENGINE
+                selectEngine();
+                break;
+            case 'F': // RENDER MODE
+                selectRenderMode();
+                break;
+            case 'G': // ACTIVITY MAP
+                selectActivity();
+                break;
+            case 'H': // THREADS
+                selectPlacement();
+                break;
+            case 'I': // FRAME SERVER
+                selectServer();
+                break;
+            case '?': // INPUT BUFFER EXCEEDED
+                printf("%sInput buffer exceeded. Please try again.", RED);
+                break;
+            case 'X': // EXIT
+                printf("Bye :)");
+                break;
+            default: // INVALID COMMAND
+                printf("%sInvalid command. Please try again.", RED);
+                break;
+        }
+
+        printf("%s", RESET_COLOR);
+        printf("\n");
+
+    } while (command != 'X');
+}
+
+/*********************************************************************
+ NAME: selectEngine
+ DESCRIPTION: Lets user choose the engine used to calculate generations
+	Input: -
+	Output: -
+  Used global variables: engine
+ REMARKS when using this function: -
+*********************************************************************/
+void selectEngine(void)
+{
+    printInstructions("engines");
+
+    switch (ask_command())
+    {
+        case 'A':
+            engine = ENGINE_REFERENCE;
+            printf("%sEngine: reference", GREEN);
+            break;
+        case 'B':
+            engine = ENGINE_TABLE;
+            printf("%sEngine: lookup table", GREEN);
+            break;
+        case 'C':
+            engine = ENGINE_DENSE;
+            printf("%sEngine: dense", GREEN);
+            break;
+        case 'D':
+            engine = ENGINE_SPARSE;
+            printf("%sEngine: sparse", GREEN);
+            break;
+        case 'E':
+            engine = ENGINE_AUTO;
+            printf("%sEngine: automatic", GREEN);
+            break;
+        default:
+            printf("%sEngine not changed", RED);
+            break;
+    }
+}
+
+/*********************************************************************
+ NAME: selectRenderMode
+ DESCRIPTION: Lets user choose how often generations are drawn
+	Input: -
+	Output: -
+  Used global variables: render_mode, render_every
+ REMARKS when using this function: -
+*********************************************************************/
+void selectRenderMode(void)
+{
+    printInstructions("render");
+
+    switch (ask_command())
+    {
+        case 'A':
+            render_mode = RENDER_EVERY;
+            printf("%sDrawing every generation", GREEN);
+            break;
+        case 'B':
+            printf("N: ");
+            render_every = ask_integer();
+            clear_input_buffer();
+            if (render_every < 1)
+                render_every = 1;
+            render_mode = RENDER_NTH;
+            printf("%sDrawing every %d generation(s)", GREEN, render_every);
+            break;
+        case 'C':
+            render_mode = RENDER_FAST;
+            printf("%sDrawing %d times per second", GREEN, REDRAW_HZ);
+            break;
+        case 'D':
+            render_mode = RENDER_NONE;
+            printf("%sHeadless, board is not drawn", GREEN);
+            break;
+        default:
+            printf("%sDraw mode not changed", RED);
+            break;
+    }
+}
+
+/*********************************************************************
+ NAME: selectActivity
+ DESCRIPTION: Lets user turn activity map on or off and choose file format
+	Input: -
+	Output: -
+  Used global variables: activity_export
+ REMARKS when using this function: -
+*********************************************************************/
+void selectActivity(void)
+{
+    printInstructions("activity");
+
+    switch (ask_command())
+    {
+        case 'A':
+            activity_export = ACTIVITY_OFF;
+            printf("%sActivity map off", GREEN);
+            break;
+        case 'B':
+            activity_export = ACTIVITY_PGM;
+            printf("%sActivity map saved as PGM", GREEN);
+            break;
+        case 'C':
+            activity_export = ACTIVITY_CSV;
+            printf("%sActivity map saved as CSV", GREEN);
+            break;
+        default:
+            printf("%sActivity map not changed", RED);
+            break;
+    }
+}
+
+/*********************************************************************
+ NAME: watchRemoteGame
+ DESCRIPTION: Connects to a frame server and shows the game it is running
+	Input: -
+	Output: -
+  Used global variables: alive_char, dead_char
+ REMARKS when using this function: address = socket path, port on this computer or host:port.
+                                    Screen is drawn at most REDRAW_HZ times per second, q quits.
+*********************************************************************/
+void watchRemoteGame(void)
+{
+    #ifdef HAVE_SYS_SOCKET_H
+    char address[100];
+    struct remoteBoard view = {0, 0, -1, 0, NULL};
+    struct byteBuffer in = {NULL, 0, 0, 0};
+    unsigned char chunk[65536];
+    struct pollfd poll_fd;
+    bool changed = false, closed = false, quit = false, failed = false;
+    double last_draw = 0;
+    ssize_t count;
+    uint32_t payload;
+    int fd;
+
+    printf("Address (socket path, port or host:port): ");
+    fgets(address, sizeof(address), stdin);
+    address[strcspn(address, "\n")] = '\0';
+
+    fd = connectViewer(address);
+    if (fd < 0)
+    {
+        printf("%sCan not connect to %s", RED, address);
+        return;
+    }
+
+    #ifdef HAVE_NCURSES_H
+    initscr();
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    #endif
+
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN;
+
+    while (quit == false && closed == false && failed == false)
+    {
+        // Wait for frames at most until next screen update
+        if (poll(&poll_fd, 1, 1000 / REDRAW_HZ) > 0)
+        {
+            count = recv(fd, chunk, sizeof(chunk), 0);
+            if (count <= 0)
+                closed = true;
+            else
+                appendBytes(&in, chunk, count);
+        }
+
+        // Apply every complete frame
+        while (failed == false && in.length - in.sent >= FRAME_HEADER_SIZE)
+        {
+            const unsigned char *frame = in.data + in.sent;
+
+            payload = frame[17] | frame[18] << 8 | frame[19] << 16 | (uint32_t)frame[20] << 24;
+            if (payload > FRAME_MAX_PAYLOAD)
+            {
+                failed = true;
+                break;
+            }
+            if (in.length - in.sent < FRAME_HEADER_SIZE + payload)
+                break;
+            failed = applyFrame(&view, frame, FRAME_HEADER_SIZE + payload) == false;
+            in.sent += FRAME_HEADER_SIZE + payload;
+            changed = true;
+        }
+        if (in.sent == in.length)
+            in.sent = in.length = 0;
+        else if (in.sent > in.capacity / 2)
+        {
+            memmove(in.data, in.data + in.sent, in.length - in.sent);
+            in.length -= in.sent;
+            in.sent = 0;
+        }
+
+        if (readKey() == 'q')
+            quit = true;
+
+        if (changed && getTime() - last_draw >= 1.0 / REDRAW_HZ)
+        {
+            printRemoteBoard(&view);
+            last_draw = getTime();
+            changed = false;
+        }
+    }
+
+    close(fd);
+    #ifdef HAVE_NCURSES_H
+    if (quit == false)
+    {
+        printRemoteBoard(&view);
+        printw("\n%s. Press any key.", failed ? "Invalid frame from server" : "Server closed connection");
+        refresh();
+        nodelay(stdscr, FALSE);
+        getch();
+    }
+    endwin();
+    #else
+    if (failed)
+        printf("%sInvalid frame from server", RED);
+    #endif
+
+    printf("Watched %ld frame(s), last generation %ld", view.frames, view.generation);
+    free(in.data);
+    free(view.cells);
+    #else
+    printf("%sWatching needs sockets (HAVE_SYS_SOCKET_H)", RED);
+    #endif
+}
+
+/*********************************************************************
+ NAME: connectViewer
+ DESCRIPTION: Opens connection to a frame server
+	Input: address
+	Output: socket, -1 if connecting failed
+  Used global variables: -
+ REMARKS when using this function: number = port on this computer, host:port = TCP, anything else = Unix socket path
+*********************************************************************/
+int connectViewer(const char *address)
+{
+    int fd = -1;
+
+    #ifdef HAVE_SYS_SOCKET_H
+    const char *colon = strrchr(address, ':');
+
+    if (isNumber(address) || colon != NULL)
+    {
+        struct addrinfo hints, *result, *entry;
+        char host[100] = "127.0.0.1";
+
+        if (colon != NULL)
+        {
+            snprintf(host, sizeof(host), "%.*s", (int)(colon - address), address);
+            address = colon + 1;
+        }
+
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, address, &hints, &result) != 0)
+            return -1;
+
+        for (entry = result; entry != NULL; entry = entry->ai_next)
+        {
+            fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+            if (fd >= 0 && connect(fd, entry->ai_addr, entry->ai_addrlen) == 0)
+                break;
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(result);
+    }
+    else
+    {
+        struct sockaddr_un unix_address;
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        memset(&unix_address, 0, sizeof(unix_address));
+        unix_address.sun_family = AF_UNIX;
+        strncpy(unix_address.sun_path, address, sizeof(unix_address.sun_path) - 1);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&unix_address, sizeof(unix_address)) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    #endif
+
+    return fd;
+}
+
+/*********************************************************************
+ NAME: applyFrame
+ DESCRIPTION: Updates remote board with a keyframe or delta frame
+	Input: view, frame, length
+	Output: TRUE, FALSE if frame is broken
+  Used global variables: -
+ REMARKS when using this function: deltas before the first keyframe are skipped. Frame format: see encodeDelta()
+*********************************************************************/
+bool applyFrame(struct remoteBoard *view, const unsigned char *frame, size_t length)
+{
+    const unsigned char *data = frame + FRAME_HEADER_SIZE, *end = frame + length;
+    uint64_t generation = 0, value, count, cell, i;
+    int width, height, part, alive = 0;
+    size_t cells;
+
+    for (i = 0; i < 8; i++)
+        generation |= (uint64_t)frame[1 + i] << (8 * i);
+    width = frame[9] | frame[10] << 8 | frame[11] << 16 | (uint32_t)frame[12] << 24;
+    height = frame[13] | frame[14] << 8 | frame[15] << 16 | (uint32_t)frame[16] << 24;
+    if (width < 1 || height < 1)
+        return false;
+    cells = (size_t)width * height;
+
+    if (frame[0] == 'K')
+    {
+        if (width != view->width || height != view->height || view->cells == NULL)
+        {
+            free(view->cells);
+            view->cells = (unsigned char*) malloc(cells);
+            if (view->cells == NULL)
+                return false;
+            view->width = width;
+            view->height = height;
+        }
+
+        // Dead and alive runs in turn
+        for (cell = 0; cell < cells; alive = !alive)
+        {
+            if (readVarint(&data, end, &count) == false || count > cells - cell)
+                return false;
+            memset(view->cells + cell, alive, count);
+            cell += count;
+        }
+    }
+    else if (frame[0] == 'D')
+    {
+        if (view->cells == NULL || width != view->width || height != view->height)
+            return true;
+
+        // Births first, then deaths
+        for (part = 0; part < 2; part++)
+        {
+            if (readVarint(&data, end, &count) == false)
+                return false;
+            for (i = 0, cell = (uint64_t)-1; i < count; i++)
+            {
+                if (readVarint(&data, end, &value) == false)
+                    return false;
+                cell += value + 1;
+                if (cell >= cells)
+                    return false;
+                view->cells[cell] = part == 0;
+            }
+        }
+    }
+    else
+        return false;
+
+    view->generation = (long)generation;
+    view->frames++;
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: readVarint
+ DESCRIPTION: Reads number written by appendVarint()
+	Input: data, end, value
+	Output: TRUE, FALSE if data ends in the middle of the number
+  Used global variables: -
+ REMARKS when using this function: data is moved past the number
+*********************************************************************/
+bool readVarint(const unsigned char **data, const unsigned char *end, uint64_t *value)
+{
+    int shift = 0;
+
+    *value = 0;
+    while (*data < end && shift < 64)
+    {
+        unsigned char byte = *(*data)++;
+
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+        shift += 7;
+    }
+
+    return false;
+}
+
+/*********************************************************************
+ NAME: printRemoteBoard
+ DESCRIPTION: displays board received from frame server
+	Input: view
+	Output: -
+  Used global variables: alive_char, dead_char
+ REMARKS when using this function: with ncurses the board is cut to the size of the terminal
+*********************************************************************/
+void printRemoteBoard(const struct remoteBoard *view)
+{
+    int x, y, rows = view->height, columns = view->width;
+
+    #ifdef HAVE_NCURSES_H
+    erase();
+    if (rows > LINES - 2)
+        rows = LINES - 2;
+    if (columns > COLS)
+        columns = COLS;
+    #else
+    printf("\n");
+    #endif
+
+    for (y = 0; y < rows && view->cells != NULL; y++)
+    {
+        for (x = 0; x < columns; x++)
+        {
+            #ifdef HAVE_NCURSES_H
+            mvaddch(y, x, view->cells[(size_t)y * view->width + x] ? alive_char : dead_char);
+            #else
+            printf("%c", view->cells[(size_t)y * view->width + x] ? alive_char : dead_char);
+            #endif
+        }
+        #ifndef HAVE_NCURSES_H
+        printf("\n");
+        #endif
+    }
+
+    #ifdef HAVE_NCURSES_H
+    mvprintw(rows + 1, 0, "Remote gen %ld | %dx%d | frames %ld | [q] quit", view->generation, view->width, view->height, view->frames);
+    refresh();
+    #else
+    printf("Remote gen %ld | %dx%d | frames %ld\n", view->generation, view->width, view->height, view->frames);
+    #endif
+}
+
+/*********************************************************************
+ NAME: selectServer
+ DESCRIPTION: Lets user turn frame server on or off
+	Input: -
+	Output: -
+  Used global variables: server_address
+ REMARKS when using this function: empty address = off
+*********************************************************************/
+void selectServer(void)
+{
+    printf("Address (socket path, or port number for TCP on localhost, empty = off): ");
+    fgets(server_address, sizeof(server_address), stdin);
+    server_address[strcspn(server_address, "\n")] = '\0';
+
+    if (server_address[0] == '\0')
+        printf("%sFrame server off", GREEN);
+    else
+        printf("%sFrame server on %s when game runs", GREEN, server_address);
+}
+
+/*********************************************************************
+ NAME: readGameFromFile
+ DESCRIPTION: Reads board state and size from file
+	Input: -
+	Output: TRUE, FALSE
+  Used global variables: xy_size, alive_cells
+ REMARKS when using this function: Default to: alive char 'o', dead char '.', if they appear in file.
+                                    Else most frequent character = alive, 2most = dead.
+                                    x size = longest line on file, y size = number of rows in file
+*********************************************************************/
+bool readGameFromFile(void)
+{
+    FILE *file;
+
+    // Ask for filename
+    char filename[100];
+    fgets(filename, 100, stdin);
+    if (strchr(filename, '\n') != NULL)
+        filename[strcspn(filename, "\n")] = '\0';
+
+    // Read from file and check for error
+    file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("%sError opening file:%s %s", RED, RESET_COLOR, filename);
+        return false;
+    }
+
+    // Check file extension .txt only
+    char *ext = strrchr(filename, '.');
+    if (strcmp(ext, ".txt") != 0) {
+        printf("Only txt files are allowed\n");
+        return 0;
+    }
+    
+    // y = rows, x = line lenght, buffer = line content, filecontent = {row}{content}
+    int ascii[256] = {0};
+    int rows = 0, i = 0, x = 0;
+    char filecontent[100][100] = {0};
+    char c;
+
+    // Read file character by character
+    while ((c = fgetc(file)) != EOF)
+    {
+        // Add this character to the file content array
+        filecontent[i][rows] = c;
+
+        // Check each line
+        if (c == '\n')
+        {
+            // Check if this is the longest row so far
+            if (i > x)
+                x = i;
+
+            i = 0;
+            rows++;
+        }
+        else
+        {
+            // Increment count for this ASCII character, and i (line character count)
+            ascii[c]++;
+            i++;
+        }
+    }
+
+    // add last line and check if last line is longest
+    rows++;
+    if (i > x)
+        x = i;
+
+    fclose(file);
+
+    int max = 0, max2 = 0, j;
+    char most_character, most_character2;
+
+    // Iterate through ASCII range
+    for (i = 0; i < 256; i++)
+    {
+        // look at each ASCII character (ascii[i]), and check which has the highest value (= which occured the most) 
+        // Also don't count newlines
+        if (ascii[i] > max && ascii[i] != '\n')
+        {
+            max = ascii[i];
+            most_character = (char)i;
+        }
+        // If it wasn't the highest value, check for 2nd highest value
+        else if (ascii[i] > max2)
+        {
+            max2 = ascii[i];
+            most_character2 = (char)i;
+        }
+    }
+
+    // Set global characters to file most and second most read characters
+    alive_char = (char)most_character;
+    dead_char = (char)most_character2;
+    xy_size[0] = x;
+    xy_size[1] = rows;
+
+    printf("Board x: %d\n", x);
+    printf("Board y: %d\n", rows);
+    
+    // default to 'o' = alive, '.' = dead, if . / o / O appear in file
+    if (most_character == '.' || most_character == 'o' || most_character == 'O' ||
+    most_character2 == '.' || most_character2 == 'o' || most_character2 == 'O') 
+    {
+        most_character = 'o';
+        alive_char = 'o';
+        dead_char = '.';
+        printf("Alive character defaulted to: o\n");
+        printf("Dead character defaulted to: .\n");
+    }
+    else
+    {
+        printf("Alive character is: %c\n", most_character);
+        printf("Dead character is: %c\n", most_character2);
+    }
+
+    
+    // Row
+    for (i = 0; i < rows; i++)
+    {
+        // column
+        for (j = 0; j < x; j++)
+        {
+            // Set alive states to corresponding positions
+            if (filecontent[j][i] == most_character)
+            {
+                alive_cells[j][i] = 1;
+            }
+            else
+            {
+                alive_cells[j][i] = 0;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: runBenchmark
+ DESCRIPTION: Measures packed engines against calculateFuture() on a random board
+	Input: -
+	Output: -
+  Used global variables: xy_size, alive_cells, **board
+ REMARKS when using this function: Board from file is saved and restored, every engine steps
+                                    the same BENCH_SEED soup for BENCH_GENERATIONS generations and
+                                    its final state is checked against calculateFuture().
+*********************************************************************/
+void runBenchmark(void)
+{
+    int saved_size[2] = {xy_size[0], xy_size[1]};
+    static int saved_cells[100][100];
+    struct benchRun run;
+    int x, y, gen;
+    double start, reference_time;
+    bool board_ready;
+
+    memcpy(saved_cells, alive_cells, sizeof(alive_cells));
+
+    // Largest board the game allows, about one third alive
+    xy_size[0] = 100;
+    xy_size[1] = 100;
+    srand(BENCH_SEED);
+    for (x = 0; x < 100; x++)
+        for (y = 0; y < 100; y++)
+            alive_cells[x][y] = (rand() % 3 == 0);
+
+    board_ready = allocateMemory();
+    if (allocateBenchRun(&run, 100, 100) == false || board_ready == false)
+        printf("%sBenchmark failed: out of memory", RED);
+    else
+    {
+        boardToGrid(&run.start);
+        if (block_table_ready == false)
+            buildBlockTable();
+
+        printf("Stepping %dx%d board for %d generations...\n", xy_size[0], xy_size[1], BENCH_GENERATIONS);
+
+        // Reference: calculateFuture()
+        start = getTime();
+        for (gen = 0; gen < BENCH_GENERATIONS; gen++)
+        {
+            calculateFuture();
+            advanceState();
+        }
+        reference_time = getTime() - start;
+        boardToGrid(&run.expected);
+
+        printf("%s%-24s %10.2f us/gen %10.2f Mcells/s\n", YELLOW, "reference", reference_time * 1e6 / BENCH_GENERATIONS,
+               (double)BENCH_GENERATIONS * 100 * 100 / reference_time / 1e6);
+        benchmarkPacked("lookup table", ENGINE_TABLE, false, &run, reference_time);
+        benchmarkPacked("lookup table + activity", ENGINE_TABLE, true, &run, reference_time);
+        benchmarkPacked("dense", ENGINE_DENSE, false, &run, reference_time);
+        benchmarkPacked("dense + activity", ENGINE_DENSE, true, &run, reference_time);
+        benchmarkPacked("sparse", ENGINE_SPARSE, false, &run, reference_time);
+        benchmarkPacked("auto", ENGINE_AUTO, false, &run, reference_time);
+    }
+
+    // Free everything that was allocated
+    freeBenchRun(&run);
+    if (board_ready)
+        deAllocateMemory();
+
+    // Restore board from file
+    xy_size[0] = saved_size[0];
+    xy_size[1] = saved_size[1];
+    memcpy(alive_cells, saved_cells, sizeof(alive_cells));
+}
+
+/*********************************************************************
+ NAME: benchmarkPacked
+ DESCRIPTION: Steps start grid of the run with a packed engine and prints the result
+	Input: name, type, with_activity, run, reference_time
+	Output: -
+  Used global variables: activity, sparse, autoselect
+ REMARKS when using this function: run->expected = state calculateFuture() reached after BENCH_GENERATIONS.
+                                    with_activity = TRUE also updates the activity map every generation.
+*********************************************************************/
+void benchmarkPacked(const char *name, enum engine_type type, bool with_activity, struct benchRun *run, double reference_time)
+{
+    struct benchStep step = {.type = type, .with_activity = with_activity};
+    double time;
+
+    if (allocateSparse(run->start.width, run->start.height) == false)
+        return;
+    if (with_activity && allocateActivity(run->start.width, run->start.height) == false)
+    {
+        freeSparse();
+        return;
+    }
+    resetAuto();
+
+    time = timeBenchRun(run, &step, BENCH_GENERATIONS);
+    printf("%-24s %10.2f us/gen %10.2f Mcells/s %8.1fx ", name, time * 1e6 / BENCH_GENERATIONS,
+           (double)BENCH_GENERATIONS * run->start.width * run->start.height / time / 1e6, reference_time / time);
+    printCheck(run);
+
+    if (with_activity)
+        freeActivity();
+    freeSparse();
+}
+
+/*********************************************************************
+ NAME: benchmarkFixed
+ DESCRIPTION: Compares every fixed size kernel with the generic dense engine
+	Input: -
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: sizes come from FIXED_SIZES
+*********************************************************************/
+void benchmarkFixed(void)
+{
+    printf("Stepping about %d Mcells per kernel...\n", FIXED_BENCH_CELLS / 1000000);
+    printf("%s%-12s %14s %14s %8s\n", YELLOW, "board", "generic", "fixed", "speedup");
+
+    #define X(W, H) benchmarkFixedSize(W, H, stepFixed##W##x##H);
+    FIXED_SIZES
+    #undef X
+
+    printf("%s", RESET_COLOR);
+}
+
+/*********************************************************************
+ NAME: benchmarkFixedSize
+ DESCRIPTION: Steps the same random board with stepDenseRows() and a fixed size kernel and prints both speeds
+	Input: width, height, kernel
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: kernel = stepFixedWxH() of the same width and height
+*********************************************************************/
+void benchmarkFixedSize(int width, int height, int (*kernel)(const struct lifeGrid *now, struct lifeGrid *next))
+{
+    struct benchRun run;
+    struct benchStep generic = {.kernel = stepDenseGeneric}, fixed = {.kernel = kernel};
+    int generations = FIXED_BENCH_CELLS / ((double)width * height);
+    double generic_time, fixed_time;
+    char name[32];
+
+    if (generations < 1)
+        generations = 1;
+    if (allocateBenchRun(&run, width, height) == false)
+    {
+        printf("%sBenchmark failed: out of memory%s\n", RED, YELLOW);
+        return;
+    }
+    fillRandomGrid(&run.start);
+
+    // Generic: runtime sizes
+    generic_time = timeBenchRun(&run, &generic, generations);
+    memcpy(run.expected.rows, run.grid[run.now].rows, (size_t)(height + 3) * run.start.words * sizeof(uint64_t));
+
+    // Fixed: constant sizes
+    fixed_time = timeBenchRun(&run, &fixed, generations);
+
+    sprintf(name, "%dx%d", width, height);
+    printf("%-12s %7.0f Mcells/s %7.0f Mcells/s %7.2fx ", name,
+           (double)generations * width * height / generic_time / 1e6, (double)generations * width * height / fixed_time / 1e6,
+           generic_time / fixed_time);
+    printCheck(&run);
+
+    freeBenchRun(&run);
+}
+
+/*********************************************************************
+ NAME: benchmarkTemporal
+ DESCRIPTION: Compares one generation per sweep with temporal blocking on a board larger than cache
+	Input: -
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: Memory traffic is estimated from what each method has to read and write:
+                                    dense reads and writes the board every generation, temporal blocking reads
+                                    tiles with halo and writes them once per k generations.
+*********************************************************************/
+void benchmarkTemporal(void)
+{
+    int size = TEMPORAL_BENCH_SIZE, i;
+    int k_values[] = {2, 4, 8, 16};
+    struct benchRun run;
+    struct temporalScratch scratch = {0};
+    struct benchStep dense = {.type = ENGINE_DENSE}, temporal = {.scratch = &scratch};
+    double time, dense_time, board_mb, traffic;
+
+    if (allocateBenchRun(&run, size, size) == false ||
+        allocateTemporal(&scratch, k_values[sizeof(k_values) / sizeof(k_values[0]) - 1]) == false)
+    {
+        printf("%sBenchmark failed: out of memory", RED);
+        freeBenchRun(&run);
+        return;
+    }
+    board_mb = (double)size * run.start.words * sizeof(uint64_t) / 1e6;
+    fillRandomGrid(&run.start);
+
+    printf("Stepping %dx%d board (%.0f MB per generation) for %d generations...\n", size, size, board_mb, TEMPORAL_BENCH_GENERATIONS);
+
+    // One generation per sweep: read now, write next
+    dense_time = timeBenchRun(&run, &dense, TEMPORAL_BENCH_GENERATIONS);
+    memcpy(run.expected.rows, run.grid[run.now].rows, (size_t)(size + 3) * run.start.words * sizeof(uint64_t));
+
+    traffic = 2 * board_mb;
+    printf("%s%-24s %10.2f ms/gen %8.0f MB/gen %8.2f GB/s\n", YELLOW, "dense, 1 gen per sweep",
+           dense_time * 1e3 / TEMPORAL_BENCH_GENERATIONS, traffic, traffic * TEMPORAL_BENCH_GENERATIONS / dense_time / 1e3);
+
+    for (i = 0; i < (int)(sizeof(k_values) / sizeof(k_values[0])); i++)
+    {
+        char name[40];
+
+        temporal.k = k_values[i];
+        time = timeBenchRun(&run, &temporal, TEMPORAL_BENCH_GENERATIONS);
+
+        // Tile with halo is read, tile is written, once per k generations
+        traffic = board_mb * ((double)(TEMPORAL_TILE_ROWS + 2 * temporal.k) * (TEMPORAL_TILE_WORDS + 2) /
+                              (TEMPORAL_TILE_ROWS * TEMPORAL_TILE_WORDS) + 1) / temporal.k;
+        sprintf(name, "temporal, k = %d", temporal.k);
+        printf("%-24s %10.2f ms/gen %8.0f MB/gen %8.2f GB/s %6.2fx ", name, time * 1e3 / TEMPORAL_BENCH_GENERATIONS,
+               traffic, traffic * TEMPORAL_BENCH_GENERATIONS / time / 1e3, dense_time / time);
+        printCheck(&run);
+    }
+
+    freeTemporal(&scratch);
+    freeBenchRun(&run);
+}
+
+/*********************************************************************
+ NAME: allocateBenchRun
+ DESCRIPTION: Allocates all grids of a benchmark run
+	Input: run, width, height
+	Output: TRUE, FALSE
+  Used global variables: -
+ REMARKS when using this function: On failure nothing stays allocated. freeBenchRun() is safe to call either way.
+*********************************************************************/
+bool allocateBenchRun(struct benchRun *run, int width, int height)
+{
+    memset(run, 0, sizeof(*run));
+
+    if (allocateGrid(&run->start, width, height) == false || allocateGrid(&run->grid[0], width, height) == false ||
+        allocateGrid(&run->grid[1], width, height) == false || allocateGrid(&run->expected, width, height) == false)
+    {
+        freeBenchRun(run);
+        return false;
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: freeBenchRun
+ DESCRIPTION: deallocates grids of a benchmark run
+	Input: run
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: deallocates memory created in allocateBenchRun()
+*********************************************************************/
+void freeBenchRun(struct benchRun *run)
+{
+    freeGrid(&run->start);
+    freeGrid(&run->grid[0]);
+    freeGrid(&run->grid[1]);
+    freeGrid(&run->expected);
+}
+
+/*********************************************************************
+ NAME: fillRandomGrid
+ DESCRIPTION: Fills grid with random cells, about half alive
+	Input: grid
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: seeded with BENCH_SEED, so every benchmark steps the same soup
+*********************************************************************/
+void fillRandomGrid(struct lifeGrid *grid)
+{
+    int x, y;
+
+    srand(BENCH_SEED);
+    for (y = 0; y < grid->height; y++)
+    {
+        for (x = 0; x < grid->words; x++)
+            GRID_ROW(grid, y)[x] = ((uint64_t)rand() << 40) ^ ((uint64_t)rand() << 20) ^ (uint64_t)rand();
+        GRID_ROW(grid, y)[grid->words - 1] &= lastWordMask(grid);
+    }
+}
+
+/*********************************************************************
+ NAME: timeBenchRun
+ DESCRIPTION: Steps start grid of the run for given generations and measures the time
+	Input: run, step, generations
+	Output: seconds
+  Used global variables: -
+ REMARKS when using this function: result is left in run->grid[run->now]. With step->k > 1 generations
+                                    should be a multiple of k.
+*********************************************************************/
+double timeBenchRun(struct benchRun *run, const struct benchStep *step, int generations)
+{
+    int gen, per_sweep = step->k > 1 ? step->k : 1;
+    double start;
+
+    memcpy(run->grid[0].rows, run->start.rows, (size_t)(run->start.height + 3) * run->start.words * sizeof(uint64_t));
+    run->now = 0;
+
+    start = getTime();
+    for (gen = 0; gen < generations; gen += per_sweep)
+    {
+        if (step->kernel != NULL)
+            step->kernel(&run->grid[run->now], &run->grid[!run->now]);
+        else if (step->k > 1)
+            stepTemporal(&run->grid[run->now], &run->grid[!run->now], step->k, step->scratch);
+        else
+            stepPacked(step->type, &run->grid[run->now], &run->grid[!run->now]);
+        if (step->with_activity)
+            accumulateActivity(&run->grid[run->now], &run->grid[!run->now]);
+        run->now = !run->now;
+    }
+
+    return getTime() - start;
+}
+
+/*********************************************************************
+ NAME: printCheck
+ DESCRIPTION: Ends a benchmark line, with a warning if the run did not reach the expected board
+	Input: run
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: compares run->grid[run->now] with run->expected
+*********************************************************************/
+void printCheck(const struct benchRun *run)
+{
+    bool same = memcmp(run->grid[run->now].rows, run->expected.rows,
+                       (size_t)(run->start.height + 3) * run->start.words * sizeof(uint64_t)) == 0;
+
+    printf("%s%s%s\n", same ? "" : RED, same ? "" : "(RESULT DIFFERS)", YELLOW);
+}
+
+/*********************************************************************
+ NAME: runLargeBoard
+ DESCRIPTION: Steps a large random board with worker threads and prints run statistics
+	Input: -
+	Output: -
+  Used global variables: run_threads, run_k, placement, pinning
+ REMARKS when using this function: Each worker owns an even stripe of rows. With run_k > 1 workers step
+                                    their stripe run_k generations at a time with temporal blocking. With first touch placement workers
+                                    write their own stripe first, so its pages land on the worker's NUMA node.
+                                    Population at the end does not depend on threads or placement.
+*********************************************************************/
+void runLargeBoard(void)
+{
+    struct largeRun run = {0};
+    int size, i, cpus[LARGE_MAX_THREADS], order[LARGE_MAX_THREADS], cpu_count;
+    long population = 0;
+    size_t row_bytes;
+
+    printf("Board size: ");
+    size = ask_integer();
+    printf("Generations: ");
+    run.generations = ask_integer();
+    clear_input_buffer();
+    if (size < 1 || run.generations < 1)
+    {
+        printf("%sSize and generations have to be positive", RED);
+        return;
+    }
+
+    cpu_count = listCpus(cpus, LARGE_MAX_THREADS);
+    run.threads = run_threads > 0 ? run_threads : cpu_count;
+    if (run.threads > LARGE_MAX_THREADS)
+        run.threads = LARGE_MAX_THREADS;
+    if (run.threads > size)
+        run.threads = size;
+    #ifndef HAVE_PTHREAD_H
+    run.threads = 1;
+    #endif
+
+    run.k = run_k < run.generations ? run_k : run.generations;
+    run.workers = (struct worker*) calloc(run.threads, sizeof(struct worker));
+    if (run.workers == NULL || allocateGridPlaced(&run.grid[0], size, size) == false ||
+        allocateGridPlaced(&run.grid[1], size, size) == false)
+    {
+        printf("%sLarge board run failed: out of memory", RED);
+        freeLargeRun(&run);
+        return;
+    }
+    for (i = 0; i < run.threads && run.k > 1; i++)
+    {
+        if (allocateTemporal(&run.workers[i].scratch, run.k) == false)
+        {
+            printf("%sLarge board run failed: out of memory", RED);
+            freeLargeRun(&run);
+            return;
+        }
+    }
+
+    // Stripes differ by one row at most. Only the page at each stripe border is shared by two workers.
+    row_bytes = run.grid[0].words * sizeof(uint64_t);
+    if (pinning == PIN_SCATTER)
+        scatterCpus(cpus, cpu_count, order);
+
+    for (i = 0; i < run.threads; i++)
+    {
+        run.workers[i].id = i;
+        run.workers[i].run = &run;
+        run.workers[i].y_begin = (int)((long long)size * i / run.threads);
+        run.workers[i].y_end = (int)((long long)size * (i + 1) / run.threads);
+        run.workers[i].cpu = -1;
+        if (pinning == PIN_COMPACT)
+            run.workers[i].cpu = cpus[i % cpu_count];
+        else if (pinning == PIN_SCATTER)
+            run.workers[i].cpu = order[i % cpu_count];
+    }
+
+    // Padding rows belong to nobody, master thread writes them
+    memset(run.grid[0].rows, 0, row_bytes);
+    memset(run.grid[1].rows, 0, row_bytes);
+    memset(GRID_ROW(&run.grid[0], size), 0, 2 * row_bytes);
+    memset(GRID_ROW(&run.grid[1], size), 0, 2 * row_bytes);
+    if (placement == PLACEMENT_MASTER)
+        initStripe(&run, 0, size);
+
+    printf("Stepping %dx%d board for %d generations with %d thread(s)...\n", size, size, run.generations, run.threads);
+
+    #ifdef HAVE_PTHREAD_H
+    // Workers wait for start_lock, so they can all be sent home if one of them can not be created
+    int created;
+
+    pthread_barrier_init(&run.barrier, NULL, run.threads);
+    pthread_mutex_init(&run.start_lock, NULL);
+    pthread_mutex_lock(&run.start_lock);
+    for (created = 0; created < run.threads; created++)
+        if (pthread_create(&run.workers[created].thread, NULL, runWorker, &run.workers[created]) != 0)
+            break;
+    run.aborted = created < run.threads;
+    pthread_mutex_unlock(&run.start_lock);
+    for (i = 0; i < created; i++)
+        pthread_join(run.workers[i].thread, NULL);
+    pthread_mutex_destroy(&run.start_lock);
+    pthread_barrier_destroy(&run.barrier);
+
+    if (run.aborted)
+    {
+        printf("%sLarge board run failed: could not start thread %d", RED, created + 1);
+        freeLargeRun(&run);
+        return;
+    }
+    #else
+    runWorker(&run.workers[0]);
+    #endif
+
+    for (i = 0; i < run.threads; i++)
+    {
+        int y, w;
+
+        for (y = run.workers[i].y_begin; y < run.workers[i].y_end; y++)
+            for (w = 0; w < run.grid[0].words; w++)
+                population += popcount64(GRID_ROW(&run.grid[run.final], y)[w]);
+        run.workers[i].memory_node = memoryNode(GRID_ROW(&run.grid[0], run.workers[i].y_begin),
+                                                (run.workers[i].y_end - run.workers[i].y_begin) * row_bytes);
+    }
+
+    // Run statistics
+    printf("%sThreads: %d | placement: %s | pinning: %s | generations per sweep: %d\n", YELLOW, run.threads,
+           placement_names[placement], pinning_names[pinning], run.k);
+    printf("Time: %.3f s | %.2f ms/gen | %.1f Mcells/s\n", run.end_time - run.start_time,
+           (run.end_time - run.start_time) * 1e3 / run.generations,
+           (double)size * size * run.generations / (run.end_time - run.start_time) / 1e6);
+    printf("Population after %d generations: %ld\n", run.generations, population);
+    for (i = 0; i < run.threads; i++)
+    {
+        printf("  worker %2d: rows %6d-%-6d cpu %3d (node %d) memory node ", i, run.workers[i].y_begin,
+               run.workers[i].y_end - 1, run.workers[i].cpu_used, cpuNode(run.workers[i].cpu_used));
+        if (run.workers[i].memory_node >= 0)
+            printf("%d\n", run.workers[i].memory_node);
+        else
+            printf("unknown\n");
+    }
+    printf("%s", RESET_COLOR);
+
+    freeLargeRun(&run);
+}
+
+/*********************************************************************
+ NAME: freeLargeRun
+ DESCRIPTION: deallocates grids, workers and their scratch tiles of a large board run
+	Input: run
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: run should start zeroed and workers be allocated with calloc(),
+                                    so parts that were not allocated are NULL.
+*********************************************************************/
+void freeLargeRun(struct largeRun *run)
+{
+    int i;
+
+    for (i = 0; run->workers != NULL && i < run->threads; i++)
+        freeTemporal(&run->workers[i].scratch);
+    freeGrid(&run->grid[0]);
+    freeGrid(&run->grid[1]);
+    free(run->workers);
+}
+
+/*********************************************************************
+ NAME: runWorker
+ DESCRIPTION: Steps one stripe of a large board, all workers wait for each other every generation
+	Input: arg (struct worker)
+	Output: NULL
+  Used global variables: placement
+ REMARKS when using this function: thread function of runLargeBoard(). Workers wait for each other after every sweep.
+*********************************************************************/
+void *runWorker(void *arg)
+{
+    struct worker *worker = (struct worker*) arg;
+    struct largeRun *run = worker->run;
+    int gen, k, now = 0;
+
+    #ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&run->start_lock);
+    pthread_mutex_unlock(&run->start_lock);
+    if (run->aborted)
+        return NULL;
+    #endif
+
+    #if defined(HAVE_PTHREAD_H) && defined(__linux__)
+    if (worker->cpu >= 0)
+    {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(worker->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    #endif
+
+    // First touch: pages of the stripe are placed on this thread's node
+    if (placement == PLACEMENT_FIRST_TOUCH)
+        initStripe(run, worker->y_begin, worker->y_end);
+
+    waitWorkers(run);
+    if (worker->id == 0)
+        run->start_time = getTime();
+
+    // Last sweep of temporal blocking takes the generations that are left
+    for (gen = 0; gen < run->generations; gen += k)
+    {
+        k = run->generations - gen < run->k ? run->generations - gen : run->k;
+        if (k == 1)
+            stepDenseRows(&run->grid[now], &run->grid[!now], worker->y_begin, worker->y_end);
+        else
+            stepTemporalRows(&run->grid[now], &run->grid[!now], k, worker->y_begin, worker->y_end, &worker->scratch);
+        waitWorkers(run);
+        now = !now;
+    }
+
+    if (worker->id == 0)
+    {
+        run->end_time = getTime();
+        run->final = now;
+    }
+    #ifdef __linux__
+    worker->cpu_used = sched_getcpu();
+    #else
+    worker->cpu_used = -1;
+    #endif
+
+    return NULL;
+}
+
+/*********************************************************************
+ NAME: waitWorkers
+ DESCRIPTION: Waits until every worker of the run gets here
+	Input: run
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: does nothing without pthreads (one worker)
+*********************************************************************/
+void waitWorkers(struct largeRun *run)
+{
+    #ifdef HAVE_PTHREAD_H
+    pthread_barrier_wait(&run->barrier);
+    #endif
+}
+
+/*********************************************************************
+ NAME: initStripe
+ DESCRIPTION: Writes rows of both generations of a large run, random cells to the first
+	Input: run, y_begin, y_end
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: cells depend only on their position, not on who writes them
+*********************************************************************/
+void initStripe(struct largeRun *run, int y_begin, int y_end)
+{
+    int y, w, words = run->grid[0].words;
+    uint64_t last_mask = lastWordMask(&run->grid[0]);
+
+    for (y = y_begin; y < y_end; y++)
+    {
+        uint64_t *row = GRID_ROW(&run->grid[0], y);
+
+        for (w = 0; w < words; w++)
+            row[w] = mixBits(((uint64_t)BENCH_SEED << 40) ^ ((uint64_t)y * words + w));
+        row[words - 1] &= last_mask;
+        memset(GRID_ROW(&run->grid[1], y), 0, words * sizeof(uint64_t));
+    }
+}
+
+/*********************************************************************
+ NAME: mixBits
+ DESCRIPTION: Returns pseudo random 64 bits for a number (splitmix64)
+	Input: x
+	Output: random bits
+  Used global variables: -
+ REMARKS when using this function: same x gives always the same bits
+*********************************************************************/
+uint64_t mixBits(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+/*********************************************************************
+ NAME: allocateGridPlaced
+ DESCRIPTION: Allocates page aligned packed grid without writing to it
+	Input: grid, width, height
+	Output: TRUE, FALSE
+  Used global variables: -
+ REMARKS when using this function: memory is not initialized, so the thread writing a page first decides
+                                    its NUMA node. Free with freeGrid().
+*********************************************************************/
+bool allocateGridPlaced(struct lifeGrid *grid, int width, int height)
+{
+    size_t bytes;
+
+    grid->width = width;
+    grid->height = height;
+    grid->words = (width + 63) / 64;
+    bytes = (size_t)(height + 3) * grid->words * sizeof(uint64_t);
+
+    grid->rows = (uint64_t*) aligned_alloc(LARGE_PAGE_SIZE, (bytes + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE * LARGE_PAGE_SIZE);
+    if (grid->rows == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for %dx%d grid\n", width, height);
+        return false;
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ NAME: listCpus
+ DESCRIPTION: Lists cpus this process may run on
+	Input: cpus, max
+	Output: count
+  Used global variables: -
+ REMARKS when using this function: without affinity support returns cpu numbers 0 ... online cpus - 1
+*********************************************************************/
+int listCpus(int *cpus, int max)
+{
+    int count = 0, cpu;
+
+    #ifdef __linux__
+    cpu_set_t set;
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (cpu = 0; cpu < CPU_SETSIZE && count < max; cpu++)
+            if (CPU_ISSET(cpu, &set))
+                cpus[count++] = cpu;
+        if (count > 0)
+            return count;
+    }
+    #endif
+
+    for (cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN) && count < max; cpu++)
+        cpus[count++] = cpu;
+
+    return count > 0 ? count : 1;
+}
+
+/*********************************************************************
+ NAME: scatterCpus
+ DESCRIPTION: Orders cpus so that consecutive workers go to different NUMA nodes
+	Input: cpus, count, order
+	Output: -
+  Used global variables: -
+ REMARKS when using this function: order[0] = first cpu of first node, order[1] = first cpu of next node ...
+                                    Node of each cpu is read once.
+*********************************************************************/
+void scatterCpus(const int *cpus, int count, int *order)
+{
+    int cpu_nodes[LARGE_MAX_THREADS], nodes[LARGE_MAX_THREADS], taken[LARGE_MAX_THREADS] = {0};
+    int i, j, node_count = 0, filled = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        cpu_nodes[i] = cpuNode(cpus[i]);
+        for (j = 0; j < node_count && nodes[j] != cpu_nodes[i]; j++);
+        if (j == node_count)
+            nodes[node_count++] = cpu_nodes[i];
+    }
+
+    // Take the next free cpu of each node in turn
+    while (filled < count)
+    {
+        for (j = 0; j < node_count; j++)
+        {
+            for (i = 0; i < count && (taken[i] || cpu_nodes[i] != nodes[j]); i++);
+            if (i < count)
+            {
+                taken[i] = 1;
+                order[filled++] = cpus[i];
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ NAME: cpuNode
+ DESCRIPTION: Returns NUMA node of cpu
+	Input: cpu
+	Output: node, 0 if it can not be found out
+  Used global variables: -
+ REMARKS when using this function: reads /sys/devices/system/cpu/cpuN/nodeM
+*********************************************************************/
+int cpuNode(int cpu)
+{
+    int node = 0;
+
+    #ifdef __linux__
+    char path[64];
+    DIR *dir;
+    struct dirent *entry;
+
+    if (cpu < 0)
+        return 0;
+
+    sprintf(path, "/sys/devices/system/cpu/cpu%d", cpu);
+    dir = opendir(path);
+    if (dir == NULL)
+        return 0;
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "node", 4) == 0 && isdigit((unsigned char)entry->d_name[4]))
+        {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    #endif
+
+    return node;
+}
+
+/*********************************************************************
+ NAME: memoryNode
+ DESCRIPTION: Returns NUMA node holding most pages of a memory area
+	Input: start, bytes
+	Output: node, -1 if it can not be found out
+  Used global variables: -
+ REMARKS when using this function: asks the kernel with move_pages() without moving anything
+*********************************************************************/
+int memoryNode(const void *start, size_t bytes)
+{
+    int best = -1;
+
+    #if defined(__linux__) && defined(SYS_move_pages)
+    void *pages[LARGE_NODE_SAMPLES];
+    int status[LARGE_NODE_SAMPLES], counts[LARGE_MAX_NODES] = {0};
+    size_t page, page_count = bytes / LARGE_PAGE_SIZE;
+    int i, samples = 0;
+
+    if (page_count == 0)
+        page_count = 1;
+
+    // Look at pages spread over the area
+    for (i = 0; i < LARGE_NODE_SAMPLES && (size_t)i < page_count; i++)
+    {
+        page = page_count * i / LARGE_NODE_SAMPLES;
+        pages[samples++] = (void*)(((uintptr_t)start + page * LARGE_PAGE_SIZE) & ~(uintptr_t)(LARGE_PAGE_SIZE - 1));
+    }
+
+    if (syscall(SYS_move_pages, 0, samples, pages, NULL, status, 0) != 0)
+        return -1;
+
+    for (i = 0; i < samples; i++)
+        if (status[i] >= 0 && status[i] < LARGE_MAX_NODES)
+            counts[status[i]]++;
+    for (i = 0; i < LARGE_MAX_NODES; i++)
+        if (counts[i] > 0 && (best < 0 || counts[i] > counts[best]))
+            best = i;
+    #endif
+
+    return best;
+}
+
+/*********************************************************************
+ NAME: selectPlacement
+ DESCRIPTION: Lets user choose threads, memory placement and thread pinning of large board runs
+	Input: -
+	Output: -
+  Used global variables: run_threads, run_k, placement, pinning
+ REMARKS when using this function: -
+*********************************************************************/
+void selectPlacement(void)
+{
+    printf("Threads (0 = one per cpu): ");
+    run_threads = ask_integer();
+    clear_input_buffer();
+    if (run_threads < 0)
+        run_threads = 0;
+    printf("Generations per sweep (1 = one at a time, 2 ... %d = temporal blocking): ", TEMPORAL_MAX_K);
+    run_k = ask_integer();
+    clear_input_buffer();
+    if (run_k < 1)
+        run_k = 1;
+    if (run_k > TEMPORAL_MAX_K)
+        run_k = TEMPORAL_MAX_K;
+
+    printInstructions("placement");
+    switch (ask_command())
+    {
+        case 'A':
+            placement = PLACEMENT_FIRST_TOUCH;
+            break;
+        case 'B':
+            placement = PLACEMENT_MASTER;
+            break;
+        default:
+            printf("%sPlacement not changed%s\n", RED, RESET_COLOR);
+            break;
+    }
+
+    printInstructions("pinning");
+    switch (ask_command())
+    {
+        case 'A':
+            pinning = PIN_NONE;
+            break;
+        case 'B':
+            pinning = PIN_COMPACT;
+            break;
+        case 'C':
+            pinning = PIN_SCATTER;
+            break;
+        default:
+            printf("%sPinning not changed%s\n", RED, RESET_COLOR);
+            break;
+    }
+
+    printf("%sThreads: %d, generations per sweep: %d, placement: %s, pinning: %s", GREEN, run_threads, run_k,
+           placement_names[placement], pinning_names[pinning]);
 }